@@ -1,12 +1,15 @@
 #include "ACXUtilities.h"
 
 #include <math.h>
+#include <algorithm>
+#include <functional>
 
 ////////////////////////////////////////////////////////////////////////////////
 // AI-Implant INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <stdlib.h>
+#include <stdio.h>
 
 // AI-implant modules
 #include <ACE_Simulation/ACE_Core.h>
@@ -31,6 +34,9 @@
 // Auxiliar macro to round in previous versions of C++11
 #define round(x) (x<0?std::ceil((x)-0.5):std::floor((x)+0.5))
 
+// Side of the buckets of the area index, in cells
+static const int AREA_INDEX_BUCKET_CELLS = 4;
+
 
 int ACXUtilities::LoadACX(const std::string path, const std::string filename, const std::string filenameBACKUP)
 {
@@ -66,7 +72,7 @@ int ACXUtilities::LoadACX(const std::string path, const std::string filename, co
     return EXIT_SUCCESS;
 }
 
-vector<vector<int>> ACXUtilities::ParseToArray()
+bool ACXUtilities::FindWorldBounds()
 {
     // Find the first StreamedArea and it dimensions.
     // In order to the algorithm works, the grid will always have the same dimensions,
@@ -75,7 +81,7 @@ vector<vector<int>> ACXUtilities::ParseToArray()
     if (solverItem == NULL)
     {
         BGT_LOG_ERROR(0, "No mainSolver specified in imported ACX file");
-        return vector<vector<int>>();
+        return false;
     }
     _mainSolver = (ACE_Solver *)solverItem;
 
@@ -85,7 +91,7 @@ vector<vector<int>> ACXUtilities::ParseToArray()
     if (_streamedAreasArray.GetSize() == 0)
     {
         BGT_LOG_ERROR(0, "No StreamedArea specified in imported ACX file");
-        return vector<vector<int>>();
+        return false;
     }
     ACE_StreamedArea *firstStrArea = (ACE_StreamedArea *)_streamedAreasArray[0];
 
@@ -97,8 +103,30 @@ vector<vector<int>> ACXUtilities::ParseToArray()
     _mainSolver->GetWorldSize(&worldSize);
     CalculateInitPosAndNumCells(worldSize, firstStrArea->GetPoint1(), _cellSize);
 
-    // Output grid
-    vector<vector<int>> resultGrid(_numCellsY, vector<int>(_numCellsX));
+    _numLoadedAreas = _streamedAreasArray.GetSize();
+
+    // Spatial index over the areas, in the same order as the array
+    areaBounds world(_initPos.x, _initPos.y - (_numCellsY * _cellSize), _initPos.x + (_numCellsX * _cellSize), _initPos.y);
+    _areaIndex.reset(new BucketGridAreaIndex(world, AREA_INDEX_BUCKET_CELLS * _cellSize));
+    for (int i = 0; i < _streamedAreasArray.GetSize(); ++i)
+    {
+        _areaIndex->Add(StreamedAreaBounds((ACE_StreamedArea *)_streamedAreasArray[i]));
+    }
+
+    return true;
+}
+
+OccupancyGrid ACXUtilities::ParseToArray()
+{
+    if (!FindWorldBounds())
+    {
+        return OccupancyGrid();
+    }
+    _compressedXs.clear();
+    _compressedYs.clear();
+
+    // Output grid (all blank)
+    OccupancyGrid resultGrid(_numCellsX, _numCellsY);
 
     // We are going through each cell (adding cellSize), and loooking if the position
     // corresponds to any StreamedArea
@@ -112,15 +140,135 @@ vector<vector<int>> ACXUtilities::ParseToArray()
         {
             BGT_V4 currentPos = BGT_V4_STATIC_CONSTRUCT(startPosX + (j*_cellSize), startPosY - (i*_cellSize), 0, 0);
 
-            if (FindFirstStreamedAreaInPoint(currentPos, _streamedAreasArray) != NULL)
+            if (FindFirstStreamedAreaInPoint(currentPos) != NULL)
             {
-                resultGrid[i][j] = 1;
+                resultGrid.Set(j, i, true);
             }
-            else
+        }
+    }
+
+    return resultGrid;
+}
+
+RunLengthGrid ACXUtilities::ParseToRunLengthArray()
+{
+    if (!FindWorldBounds())
+    {
+        return RunLengthGrid();
+    }
+    _compressedXs.clear();
+    _compressedYs.clear();
+
+    // Output grid (all occupied until the blank runs are added)
+    RunLengthGrid resultGrid(_numCellsX, _numCellsY);
+
+    // Same cell centers as ParseToArray, but each StreamedArea crossing a row gives
+    // its whole span of cells at once.
+    double startPosX = _initPos.x + (_cellSize / 2.0);
+    double startPosY = _initPos.y - (_cellSize / 2.0);
+
+    vector<pair<int, int>> occupiedSpans;
+    for (int i = 0; i < _numCellsY; ++i)
+    {
+        double posY = startPosY - (i*_cellSize);
+
+        occupiedSpans.clear();
+        for (int strAreaIdx = 0; strAreaIdx < _streamedAreasArray.GetSize(); ++strAreaIdx)
+        {
+            ACE_StreamedArea *strArea = (ACE_StreamedArea *)_streamedAreasArray[strAreaIdx];
+            double bottom = std::min(strArea->GetPoint1().y, strArea->GetPoint2().y);
+            double top = std::max(strArea->GetPoint1().y, strArea->GetPoint2().y);
+            if (posY < bottom || posY > top)
+                continue;
+
+            // Cells with the center into the area
+            double left = std::min(strArea->GetPoint1().x, strArea->GetPoint2().x);
+            double right = std::max(strArea->GetPoint1().x, strArea->GetPoint2().x);
+            int firstCell = std::max(0, (int)ceil((left - startPosX) / _cellSize));
+            int lastCell = std::min(_numCellsX - 1, (int)floor((right - startPosX) / _cellSize));
+            if (firstCell <= lastCell)
             {
-                resultGrid[i][j] = 0;
+                occupiedSpans.push_back(std::make_pair(firstCell, lastCell));
             }
         }
+
+        // The blank runs are the gaps between the (sorted) occupied spans
+        std::sort(occupiedSpans.begin(), occupiedSpans.end());
+        int nextBlank = 0;
+        for (int k = 0; k < occupiedSpans.size(); ++k)
+        {
+            if (occupiedSpans[k].first > nextBlank)
+            {
+                resultGrid.AddRun(i, nextBlank, occupiedSpans[k].first - 1);
+            }
+            nextBlank = std::max(nextBlank, occupiedSpans[k].second + 1);
+        }
+        if (nextBlank < _numCellsX)
+        {
+            resultGrid.AddRun(i, nextBlank, _numCellsX - 1);
+        }
+    }
+
+    return resultGrid;
+}
+
+OccupancyGrid ACXUtilities::ParseToCompressedArray()
+{
+    if (!FindWorldBounds())
+    {
+        return OccupancyGrid();
+    }
+
+    // The world limits and every side of the StreamedAreas (inside the world) are the
+    // lines of the grid. Columns go left to right, rows top to bottom (y going down).
+    double minX = _initPos.x;
+    double maxX = _initPos.x + (_numCellsX * _cellSize);
+    double maxY = _initPos.y;
+    double minY = _initPos.y - (_numCellsY * _cellSize);
+
+    _compressedXs.clear();
+    _compressedYs.clear();
+    _compressedXs.push_back(minX);
+    _compressedXs.push_back(maxX);
+    _compressedYs.push_back(maxY);
+    _compressedYs.push_back(minY);
+    for (int i = 0; i < _streamedAreasArray.GetSize(); ++i)
+    {
+        ACE_StreamedArea *area = (ACE_StreamedArea *)_streamedAreasArray[i];
+        double xs[2] = { round(area->GetPoint1().x), round(area->GetPoint2().x) };
+        double ys[2] = { round(area->GetPoint1().y), round(area->GetPoint2().y) };
+        for (int k = 0; k < 2; ++k)
+        {
+            if (xs[k] > minX && xs[k] < maxX)
+                _compressedXs.push_back(xs[k]);
+            if (ys[k] > minY && ys[k] < maxY)
+                _compressedYs.push_back(ys[k]);
+        }
+    }
+    std::sort(_compressedXs.begin(), _compressedXs.end());
+    _compressedXs.erase(std::unique(_compressedXs.begin(), _compressedXs.end()), _compressedXs.end());
+    std::sort(_compressedYs.begin(), _compressedYs.end(), std::greater<double>());
+    _compressedYs.erase(std::unique(_compressedYs.begin(), _compressedYs.end()), _compressedYs.end());
+
+    // Output grid (all blank): one cell between every 2 consecutive lines
+    OccupancyGrid resultGrid(_compressedXs.size() - 1, _compressedYs.size() - 1);
+
+    // Every StreamedArea covers a whole block of cells: mark it at once
+    for (int i = 0; i < _streamedAreasArray.GetSize(); ++i)
+    {
+        ACE_StreamedArea *area = (ACE_StreamedArea *)_streamedAreasArray[i];
+        double left = std::max(minX, std::min(round(area->GetPoint1().x), round(area->GetPoint2().x)));
+        double right = std::min(maxX, std::max(round(area->GetPoint1().x), round(area->GetPoint2().x)));
+        double top = std::min(maxY, std::max(round(area->GetPoint1().y), round(area->GetPoint2().y)));
+        double bottom = std::max(minY, std::min(round(area->GetPoint1().y), round(area->GetPoint2().y)));
+        if (left >= right || bottom >= top)
+            continue; // out of the world
+
+        int firstColumn = std::lower_bound(_compressedXs.begin(), _compressedXs.end(), left) - _compressedXs.begin();
+        int lastColumn = std::lower_bound(_compressedXs.begin(), _compressedXs.end(), right) - _compressedXs.begin() - 1;
+        int firstRow = std::lower_bound(_compressedYs.begin(), _compressedYs.end(), top, std::greater<double>()) - _compressedYs.begin();
+        int lastRow = std::lower_bound(_compressedYs.begin(), _compressedYs.end(), bottom, std::greater<double>()) - _compressedYs.begin() - 1;
+        resultGrid.SetRectangle(coord2D(firstColumn, firstRow), coord2D(lastColumn, lastRow), true);
     }
 
     return resultGrid;
@@ -128,28 +276,50 @@ vector<vector<int>> ACXUtilities::ParseToArray()
 
 void ACXUtilities::CreateNewStreamedAreas(vector<rectangle> rectangles)
 {
-    // Go through the grid and multiplies the coord2D for cellSize to set the new rectangles.
     for (auto rect = rectangles.begin(); rect != rectangles.end(); ++rect)
     {
-        BGT_V4 point1 = BGT_V4_STATIC_CONSTRUCT(_initPos.x + (rect->corner1.x*_cellSize), _initPos.y - (rect->corner1.y*_cellSize), 0, 0);
-        BGT_V4 point2 = BGT_V4_STATIC_CONSTRUCT(_initPos.x + (rect->corner2.x*_cellSize) + _cellSize, _initPos.y - (rect->corner2.y*_cellSize) - _cellSize, 0, 0);
+        CreateNewStreamedArea(*rect);
+    }
+}
+
+ACE_StreamedArea* ACXUtilities::CreateNewStreamedArea(const rectangle &rect)
+{
+    // Multiplies the coord2D for cellSize to set the new rectangle
+    // (or takes the lines of the compressed grid, when it was parsed that way).
+    BGT_V4 point1;
+    BGT_V4 point2;
+    if (_compressedXs.empty())
+    {
+        point1 = BGT_V4_STATIC_CONSTRUCT(_initPos.x + (rect.corner1.x*_cellSize), _initPos.y - (rect.corner1.y*_cellSize), 0, 0);
+        point2 = BGT_V4_STATIC_CONSTRUCT(_initPos.x + (rect.corner2.x*_cellSize) + _cellSize, _initPos.y - (rect.corner2.y*_cellSize) - _cellSize, 0, 0);
+    }
+    else
+    {
+        // Compressed grid: the cells are the spaces between its lines
+        point1 = BGT_V4_STATIC_CONSTRUCT(_compressedXs[rect.corner1.x], _compressedYs[rect.corner1.y], 0, 0);
+        point2 = BGT_V4_STATIC_CONSTRUCT(_compressedXs[rect.corner2.x + 1], _compressedYs[rect.corner2.y + 1], 0, 0);
+    }
 
-        ACE_StreamedArea *newArea = ACE_StreamedArea::CreateObject();
+    ACE_StreamedArea *newArea = ACE_StreamedArea::CreateObject();
 
-        newArea->SetName("StreamedArea_NEW");
-        newArea->SetPoint1(point1);
-        newArea->SetPoint2(point2);
-        newArea->SetStreamTrigger(ACE_StreamedArea::StreamTrigger::triggerDISTANCE);
-        newArea->SetStreamSource(ACE_StreamedArea::sourceOTHER);
-        newArea->SetTriggerDistance(((ACE_StreamedArea *)_streamedAreasArray[0])->GetTriggerDistance());
-        newArea->SetDecayTime(((ACE_StreamedArea *)_streamedAreasArray[0])->GetDecayTime());
+    newArea->SetName("StreamedArea_NEW");
+    newArea->SetPoint1(point1);
+    newArea->SetPoint2(point2);
+    newArea->SetStreamTrigger(ACE_StreamedArea::StreamTrigger::triggerDISTANCE);
+    newArea->SetStreamSource(ACE_StreamedArea::sourceOTHER);
+    newArea->SetTriggerDistance(((ACE_StreamedArea *)_streamedAreasArray[0])->GetTriggerDistance());
+    newArea->SetDecayTime(((ACE_StreamedArea *)_streamedAreasArray[0])->GetDecayTime());
 
-        _mainSolver->AddChild(newArea);
-        _streamedAreasArray.Append(newArea);
-    }
+    _mainSolver->AddChild(newArea);
+    _streamedAreasArray.Append(newArea);
+    _areaIndex->Add(StreamedAreaBounds(newArea));
+
+    return newArea;
 }
 
 
+int WayPointCounter = 0;
+
 //// TODO: Otra forma bastante ms eficiente sera ir recorriendo todos los Streamed Areas
 //// Y por cada uno, ir preguntando si el resto estn "pegados" (viendo las coordenadas (x,y) de p1 y p2
 //// La lgica de "AreaIsAdjacentTo" sera algo as como comprobar si alguna coordenada de p1
@@ -169,127 +339,63 @@ void ACXUtilities::CreateNewStreamedAreas(vector<rectangle> rectangles)
 ////        }
 ////    }
 ////}
-void ACXUtilities::CreateConnections()
+void ACXUtilities::CreateConnections(bool incremental)
 {
-    // remove all the existant connections and waypoints (to simplify)
     ACE_IInventoryItem::ItemArray wayPoints;
     _mainSolver->GetDescendants(&wayPoints, BGT_OBJECT_TYPE(ACE_WayPoint));
-    for (int i = 0; i < wayPoints.GetSize(); ++i)
-    {
-        _inventory.RemoveItem(wayPoints[i]);
-    }
-
-    ACE_IInventoryItem::ItemArray metaconnections;
-    _mainSolver->GetDescendants(&metaconnections, BGT_OBJECT_TYPE(ACE_MetaConnection));
-
-    for (int i = 0; i < metaconnections.GetSize(); ++i)
-    {
-        _inventory.RemoveItem(metaconnections[i]->GetId());
-    }
-
-    // Adjacency List (graph) with all StreamedAreas connected.
-    // If 1 & 2 are connected, "2" will be in the 1's list, BUT "1" WILL NOT BE IN 2's list
-    vector<vector<int>> adjacencyLists;
-    for (int i = 0; i < _streamedAreasArray.GetSize(); ++i)
-    {
-        adjacencyLists.push_back(vector<int>());
-    }
-
-    //
-    // The algorithm will go through all the logic cells, and check if the current position
-    // has changed from one to other StreamedArea. Then, there is a link between the current and
-    // the previous areas.
-    // We must repeat this logic in horizontal and vertical to find all the connections.
-    // We start in the upper-left corner.
-    //
-
-    // Starting point (init pos + little offset)
-    double startPosX = _initPos.x + (_cellSize / 2.0);
-    double startPosY = _initPos.y - (_cellSize / 2.0);
-
-    ACE_StreamedArea *previousArea;
-    ACE_StreamedArea *currentArea;
 
-    int totalLinks = 0;
+    // Areas linked from this one on (the rest are linked among them already)
+    int firstNewArea = 0;
 
-    // FIND HORIZONTAL CONNECTIONS
-    for (int i = 0; i < _numCellsY; ++i)
+    if (incremental)
     {
-        previousArea = NULL;
-        currentArea = NULL;
+        // Keep the existant connections and waypoints: only the links that touch
+        // an area added after loading the ACX file are created.
+        firstNewArea = _numLoadedAreas;
 
-        for (int j = 0; j < _numCellsX; ++j)
+        // The new waypoints are numbered after the existant ones
+        for (int i = 0; i < wayPoints.GetSize(); ++i)
         {
-            BGT_V4 currentPos = BGT_V4_STATIC_CONSTRUCT(startPosX + (j*_cellSize), startPosY - (i*_cellSize), 0, 0);
-
-            currentArea = FindFirstStreamedAreaInPoint(currentPos, _streamedAreasArray);
-
-            if (previousArea != NULL && currentArea == NULL)
-            {
-                std::cout << "ERROR: ALL POSITIONS MUST CORRESPOND TO A STREAMEDAREA." << endl;
-                previousArea = NULL;
-            }
-            else if (previousArea != NULL && currentArea->GetId() != previousArea->GetId())
+            int number;
+            if (sscanf(wayPoints[i]->GetName(), "WayPoint_%d", &number) == 1 && number >= WayPointCounter)
             {
-                int previousAreaIndx = _streamedAreasArray.Find(previousArea);
-                int currentAreaIndx = _streamedAreasArray.Find(currentArea);
-
-                // If it is not inserted yet
-                if (std::find(adjacencyLists[previousAreaIndx].begin(), adjacencyLists[previousAreaIndx].end(), currentAreaIndx) == adjacencyLists[previousAreaIndx].end())
-                {
-                    adjacencyLists[previousAreaIndx].push_back(currentAreaIndx);
-                    totalLinks++;
-                }
+                WayPointCounter = number + 1;
             }
-
-            previousArea = currentArea;
         }
     }
-
-    // FIND VERTICAL CONNECTIONS
-    for (int j = 0; j < _numCellsX; ++j)
+    else
     {
-        previousArea = NULL;
-        currentArea = NULL;
-
-        for (int i = 0; i < _numCellsY; ++i)
+        // remove all the existant connections and waypoints (to simplify)
+        for (int i = 0; i < wayPoints.GetSize(); ++i)
         {
-            BGT_V4 currentPos = BGT_V4_STATIC_CONSTRUCT(startPosX + (j*_cellSize), startPosY - (i*_cellSize), 0, 0);
-
-            currentArea = FindFirstStreamedAreaInPoint(currentPos, _streamedAreasArray);
+            _inventory.RemoveItem(wayPoints[i]);
+        }
 
-            if (previousArea != NULL && currentArea == NULL)
-            {
-                std::cout << "ERROR: ALL POSITIONS MUST CORRESPOND TO A STREAMEDAREA." << endl;
-                previousArea = NULL;
-            }
-            else if (previousArea != NULL && currentArea->GetId() != previousArea->GetId())
-            {
-                int previousAreaIndx = _streamedAreasArray.Find(previousArea);
-                int currentAreaIndx = _streamedAreasArray.Find(currentArea);
-
-                // If it is not inserted yet
-                if (std::find(adjacencyLists[previousAreaIndx].begin(), adjacencyLists[previousAreaIndx].end(), currentAreaIndx) == adjacencyLists[previousAreaIndx].end())
-                {
-                    adjacencyLists[previousAreaIndx].push_back(currentAreaIndx);
-                    totalLinks++;
-                }
-            }
+        ACE_IInventoryItem::ItemArray metaconnections;
+        _mainSolver->GetDescendants(&metaconnections, BGT_OBJECT_TYPE(ACE_MetaConnection));
 
-            previousArea = currentArea;
+        for (int i = 0; i < metaconnections.GetSize(); ++i)
+        {
+            _inventory.RemoveItem(metaconnections[i]->GetId());
         }
     }
 
+    //
+    // The StreamedAreas are rectangles: their sides are sorted and swept to find
+    // the pairs that share a segment, without going through the cells of the world.
+    // If 1 & 2 are connected, the link is 1 -> 2 (1 is left or above), BUT NOT 2 -> 1
+    //
+    vector<areaLink> links;
+    SweepLinks(RoundedStreamedAreaBounds(), links, firstNewArea);
+
     // CONNECT ALL THE FOUND CONNECTIONS.
-    for (int vector1Idx=0; vector1Idx < adjacencyLists.size(); ++vector1Idx)
+    for (int i = 0; i < links.size(); ++i)
     {
-        ACE_StreamedArea *area1 = (ACE_StreamedArea *)_streamedAreasArray[vector1Idx];
-        for (int vector2Idx = 0; vector2Idx < adjacencyLists[vector1Idx].size(); ++vector2Idx)
-        {
-            ACE_StreamedArea *area2 = (ACE_StreamedArea *)_streamedAreasArray[adjacencyLists[vector1Idx][vector2Idx]];
-            Connect2StreamedAreas(area1, area2);
-        }
+        ACE_StreamedArea *area1 = (ACE_StreamedArea *)_streamedAreasArray[links[i].area1];
+        ACE_StreamedArea *area2 = (ACE_StreamedArea *)_streamedAreasArray[links[i].area2];
+        Connect2StreamedAreas(area1, area2, links[i].segment);
     }
+    int totalLinks = links.size();
 
     ACE_MetaConnectionNetwork *metaConnectionNet = (ACE_MetaConnectionNetwork *)_mainSolver->GetFirstActiveChildOfType(BGT_OBJECT_TYPE(ACE_MetaConnectionNetwork));
     metaConnectionNet->GenerateEdges();
@@ -307,58 +413,36 @@ void ACXUtilities::ExportInventory(const std::string path, const std::string fil
 }
 
 
-ACE_StreamedArea* ACXUtilities::FindFirstStreamedAreaInPoint(BGT_V4 point, ACE_IInventoryItem::ItemArray streamedAreasArray)
+ACE_StreamedArea* ACXUtilities::FindFirstStreamedAreaInPoint(const BGT_V4 &point)
 {
-    // For each StreamedArea
-    for (int strAreaIdx = 0; strAreaIdx < streamedAreasArray.GetSize(); ++strAreaIdx)
+    // Only the areas that share the bucket of the point are tested
+    int strAreaIdx = _areaIndex->FindFirst(point.x, point.y);
+    if (strAreaIdx == -1)
     {
-        // It's within the bounds
-        ACE_StreamedArea *strArea = (ACE_StreamedArea *)streamedAreasArray[strAreaIdx];
-        if (PointIsIntoStreamedArea(point, strArea))
-        {
-            return strArea;
-        }
+        return NULL;
     }
+    return (ACE_StreamedArea *)_streamedAreasArray[strAreaIdx];
+}
 
-    return NULL;
+vector<areaBounds> ACXUtilities::RoundedStreamedAreaBounds()
+{
+    // Rounded, as the sides only meet when they are equal
+    vector<areaBounds> areas;
+    areas.reserve(_streamedAreasArray.GetSize());
+    for (int i = 0; i < _streamedAreasArray.GetSize(); ++i)
+    {
+        areaBounds bounds = StreamedAreaBounds((ACE_StreamedArea *)_streamedAreasArray[i]);
+        areas.push_back(areaBounds(round(bounds.minX), round(bounds.minY), round(bounds.maxX), round(bounds.maxY)));
+    }
+    return areas;
 }
 
-bool ACXUtilities::PointIsIntoStreamedArea(BGT_V4 point, ACE_StreamedArea * area)
+areaBounds ACXUtilities::StreamedAreaBounds(ACE_StreamedArea * area)
 {
-    // There is 4 possibilities that the point will be INTO the area.
-    // "1" is the point1 of the area, "2" is the point2 of the area, and the "X" is the point
-    //
-    //    OPT1           OPT2           OPT3           OPT4
-    // 1---------|    ----------2    2---------|    ----------1
-    // |         |    |         |    |         |    |         |
-    // |    X    |    |    X    |    |    X    |    |    X    |
-    // |         |    |         |    |         |    |         |
-    // ----------2    1----------    ----------1    2----------
-    //
-    // We must check the 4 possibilities:
-
-    bool opt1 = point.x >= area->GetPoint1().x &&
-                point.x <= area->GetPoint2().x &&
-                point.y >= area->GetPoint1().y &&
-                point.y <= area->GetPoint2().y;
-
-    bool opt2 = point.x >= area->GetPoint1().x &&
-                point.x <= area->GetPoint2().x &&
-                point.y <= area->GetPoint1().y &&
-                point.y >= area->GetPoint2().y;
-
-    bool opt3 = point.x <= area->GetPoint1().x &&
-                point.x >= area->GetPoint2().x &&
-                point.y <= area->GetPoint1().y &&
-                point.y >= area->GetPoint2().y;
-
-    bool opt4 = point.x <= area->GetPoint1().x &&
-                point.x >= area->GetPoint2().x &&
-                point.y >= area->GetPoint1().y &&
-                point.y <= area->GetPoint2().y;
-
-    // returns TRUE when any of the options is TRUE
-    return opt1 || opt2 || opt3 || opt4;
+    // point1 and point2 can be any pair of opposite corners
+    BGT_V4 point1 = area->GetPoint1();
+    BGT_V4 point2 = area->GetPoint2();
+    return areaBounds(std::min(point1.x, point2.x), std::min(point1.y, point2.y), std::max(point1.x, point2.x), std::max(point1.y, point2.y));
 }
 
 //bool ACXUtilities::AreaIsAdjacentTo(ACE_StreamedArea * area1, ACE_StreamedArea * area2)
@@ -375,35 +459,16 @@ bool ACXUtilities::PointIsIntoStreamedArea(BGT_V4 point, ACE_StreamedArea * area
 //    return true;
 //}
 
-int WayPointCounter = 0;
 
-void ACXUtilities::Connect2StreamedAreas(ACE_StreamedArea * area1, ACE_StreamedArea * area2)
+void ACXUtilities::Connect2StreamedAreas(ACE_StreamedArea * area1, ACE_StreamedArea * area2, const areaBounds &segment)
 {
     // The areas are connected in the middle of the 2 coincident areas.
     // We will create 2 Waypoints (1 in each area), add it to the MainMetaConnection,
     // and create the MetaConnection.
 
-    BGT_V4 a1_p1 = BGT_V4_STATIC_CONSTRUCT(round(area1->GetPoint1().x), round(area1->GetPoint1().y), 0, 0);
-    BGT_V4 a1_p2 = BGT_V4_STATIC_CONSTRUCT(round(area1->GetPoint2().x), round(area1->GetPoint2().y), 0, 0);
-    BGT_V4 a2_p1 = BGT_V4_STATIC_CONSTRUCT(round(area2->GetPoint1().x), round(area2->GetPoint1().y), 0, 0);
-    BGT_V4 a2_p2 = BGT_V4_STATIC_CONSTRUCT(round(area2->GetPoint2().x), round(area2->GetPoint2().y), 0, 0);
-
-    // TODO: Checkear que al menos tienen un lado en comn [jfmartinezd]
-
-    // Calculate the segment of intersection from the 2 rectangles
-    // - https://stackoverflow.com/questions/19753134/get-the-points-of-intersection-from-2-rectangles
-    // There are several ways to do it.
-    // The max&min way forces us to normalize the rectangles (p1.x < p2.x && p1.y < p2.y),
-    // but we can't guarantee it.
-    // Instead, we will sort the 4 Xcoord and Ycoord, and will take the 2 of te middle.
-
-    int xs[4] = { a1_p1.x, a1_p2.x, a2_p1.x, a2_p2.x };
-    int ys[4] = { a1_p1.y, a1_p2.y, a2_p1.y, a2_p2.y };
-    std::sort(xs, xs+4);
-    std::sort(ys, ys+4);
-
-    BGT_V4 segment_p1 = BGT_V4_STATIC_CONSTRUCT(xs[1], ys[1], 0, 0);
-    BGT_V4 segment_p2 = BGT_V4_STATIC_CONSTRUCT(xs[2], ys[2], 0, 0);
+    // The segment of intersection from the 2 rectangles comes from the sweep (SweepLinks)
+    BGT_V4 segment_p1 = BGT_V4_STATIC_CONSTRUCT(segment.minX, segment.minY, 0, 0);
+    BGT_V4 segment_p2 = BGT_V4_STATIC_CONSTRUCT(segment.maxX, segment.maxY, 0, 0);
 
     // Calculate the middlePoint (the center of both coordinates).
     BGT_V4 middlePoint = BGT_V4_STATIC_CONSTRUCT((segment_p1.x + segment_p2.x)/2.0f, (segment_p1.y + segment_p2.y)/2.0f, 0, 0);
@@ -411,24 +476,19 @@ void ACXUtilities::Connect2StreamedAreas(ACE_StreamedArea * area1, ACE_StreamedA
     ACE_WayPoint *wPoint1;
     ACE_WayPoint *wPoint2;
 
-    float offSet = 10.0f; // Admitted error for 2 points to be "in the same position"
     float wayPointRadius = 500.0f;
 
     // Create the points, and move the middlePoint depending on the orientation
-    if (abs(segment_p1.x - segment_p2.x) <= offSet) // vertical segment
+    if (segment.minX == segment.maxX) // vertical segment
     {
         wPoint1 = CreateWayPoint(middlePoint.x - wayPointRadius, middlePoint.y, WayPointCounter++, wayPointRadius);
         wPoint2 = CreateWayPoint(middlePoint.x + wayPointRadius, middlePoint.y, WayPointCounter++, wayPointRadius);
     }
-    else if (abs(segment_p1.y - segment_p2.y) <= offSet) // horizontal segment
+    else // horizontal segment
     {
         wPoint1 = CreateWayPoint(middlePoint.x, middlePoint.y - wayPointRadius, WayPointCounter++, wayPointRadius);
         wPoint2 = CreateWayPoint(middlePoint.x, middlePoint.y + wayPointRadius, WayPointCounter++, wayPointRadius);
     }
-    else
-    {
-        std::cout << "ERROR: X or Y MUST BE THE SAME..." << endl;
-    }
 
     ACE_MetaConnectionNetwork *metaConnectionNet = (ACE_MetaConnectionNetwork *)_mainSolver->GetFirstActiveChildOfType(BGT_OBJECT_TYPE(ACE_MetaConnectionNetwork));
     metaConnectionNet->AddWayPoint(wPoint1);
@@ -494,105 +554,105 @@ void ACXUtilities::CalculateInitPosAndNumCells(BGT_V4 worldSize, BGT_V4 rectangl
 // TODO: Este mtodo de construccin de geometra es el ms lento de todo el proceso
 // Como no va a ser un algoritmo que corra en tiempo real, no nos procupa el tiempo de ejecucin.
 // Igualmente, ver si se puede optimizar un poco este proceso. [jfmartinezd]
-void ACXUtilities::GenerateTessellatedMeshBarriersAndNavMeshes()
+void ACXUtilities::GenerateTessellatedMeshBarriersAndNavMeshes(MeshMode mode)
 {
+    // QUADS and TRIANGLES: every area needs a vertex on its sides where a
+    // neighbour's corner lies (T-junction), that is, at the ends of the shared segments
+    vector<vector<meshVertex>> sideVertices(_streamedAreasArray.GetSize());
+    if (mode != MeshMode::TILES)
+    {
+        vector<areaLink> links;
+        SweepLinks(RoundedStreamedAreaBounds(), links);
+        for (int i = 0; i < links.size(); ++i)
+        {
+            const areaBounds &segment = links[i].segment;
+            meshVertex ends[2] = { meshVertex(segment.minX, segment.minY), meshVertex(segment.maxX, segment.maxY) };
+            for (int j = 0; j < 2; ++j)
+            {
+                sideVertices[links[i].area1].push_back(ends[j]);
+                sideVertices[links[i].area2].push_back(ends[j]);
+            }
+        }
+    }
+
     for (int i = 0; i < _streamedAreasArray.GetSize(); ++i)
     {
         ACE_StreamedArea * area = (ACE_StreamedArea *)_streamedAreasArray[i];
 
         if (strcmp(area->GetName(), "StreamedArea_NEW") == 0) // Only with NEW areas
         {
-            BGT_V4 point1 = area->GetPoint1();
-            BGT_V4 point2 = area->GetPoint2();
-
-            // MESH TO CREATE THE NEW GEOMETRY
-            BGT_Mesh *meshShape = BGT_Mesh::CreateObject();
-
-            int numTilesX = round(abs(point1.x - point2.x) / _cellSize);
-            int numTilesY = round(abs(point1.y - point2.y) / _cellSize);
-
-            // Declare an Array of Polys to store temporarily the poly's vertices
-            int PolyCount = (numTilesX * numTilesY);
-            int VertexCount = 4; // 4 is the number of vertex of each poly (squares in this case)
-            BGT_V4 *Polys = new BGT_V4[(PolyCount * VertexCount)];
-
-            // We define the tile's vertices of a square IN ANTICLOCKWISE ORDER
-            // VERY IMPORTANT TO DEFINE THE VERTEX GEOMETRY IN THIS ORDER!!!!!
-            //
-            // Ex.
-            // 1 --- 4
-            // |     |
-            // |     |
-            // 2 --- 3
-            // TODO: Puede ser ms ptimo para los clculos de AI.Implant tener la geometra en tringulos?
-            // Estudiar si hay alguna diferencia de eficiencia, y cambiar por 2 tringulos si fuera necesario [jfmartinezd]
-
-            for (int j = 0; j < numTilesY; ++j)
-            {
-                for (int i = 0; i < numTilesX; ++i)
-                {
-                    BGT_V4 polyVertex1 = BGT_V4_STATIC_CONSTRUCT(point1.x + (i*_cellSize), point1.y - (j*_cellSize), 0, 0);
-                    BGT_V4 polyVertex2 = BGT_V4_STATIC_CONSTRUCT(point1.x + (i*_cellSize), point1.y - (j*_cellSize) - _cellSize, 0, 0);
-                    BGT_V4 polyVertex3 = BGT_V4_STATIC_CONSTRUCT(point1.x + (i*_cellSize) + _cellSize, point1.y - (j*_cellSize) - _cellSize, 0, 0);
-                    BGT_V4 polyVertex4 = BGT_V4_STATIC_CONSTRUCT(point1.x + (i*_cellSize) + _cellSize, point1.y - (j*_cellSize), 0, 0);
-
-                    int polyIdx = (j*numTilesX * 4) + (i * 4);
-
-                    Polys[polyIdx + 0] = polyVertex1;
-                    Polys[polyIdx + 1] = polyVertex2;
-                    Polys[polyIdx + 2] = polyVertex3;
-                    Polys[polyIdx + 3] = polyVertex4;
-                }
-            }
+            GenerateTessellatedMeshBarrierAndNavMesh(area, mode, sideVertices[i]);
+        }
+    }
+}
 
-            // Make a buffer to hold the vertex indices of a single poly
-            int *vertIndices = new int[VertexCount];
+void ACXUtilities::GenerateTessellatedMeshBarrierAndNavMesh(ACE_StreamedArea * area, MeshMode mode, const vector<meshVertex> &sideVertices)
+{
+    areaBounds bounds = StreamedAreaBounds(area);
+
+    // MESH TO CREATE THE NEW GEOMETRY
+    // TILES: one square per cell of the world. The vertices are numbered from the
+    // lattice of the tiles (MeshBuilder), so no vertex is searched in the mesh.
+    // The tiles follow the cells, clipped to the actual bounds of the area: sides off
+    // the cell lattice (compressed grid) give partial tiles, not a rounded tile count.
+    // QUADS / TRIANGLES: one polygon or 2 triangles for the whole area.
+    MeshBuilder builder;
+    if (mode == MeshMode::TILES)
+    {
+        vector<double> xs = MeshBuilder::LatticeLines(bounds.minX, bounds.maxX, _initPos.x, _cellSize);
+        vector<double> ys = MeshBuilder::LatticeLines(bounds.maxY, bounds.minY, _initPos.y, _cellSize);
+        builder.AddTileLattice(xs, ys);
+    }
+    else
+    {
+        // The whole area at once (rounded, like the side vertices)
+        builder.AddRectangle(meshVertex(round(bounds.minX), round(bounds.maxY)), meshVertex(round(bounds.maxX), round(bounds.minY)), sideVertices, mode);
+    }
+    BGT_Mesh *meshShape = CreateMeshShape(builder);
+
+    // 1. GET THE EXISTENT MESHBARRIER -- OPTION 1
+    //ACE_IInventoryItem::Id barrierID = area->GetMeshBarrierId();
+    //if (barrierID == 0)
+    //{
+    //    // This makes sure the main MeshBarrier is created for the StreamedArea.
+    //    area->SetShape(NULL);
+    //    barrierID = area->GetMeshBarrierId();
+    //}
+
+    //ACE_IInventoryItem* barrierItem = area->GetInventory()->Find(barrierID);
+    //ACE_MeshBarrier *meshBarrier = (ACE_MeshBarrier*)barrierItem;
+    //meshBarrier->SetShape(meshShape);
+
+    //2. CREATE A NEW MESHBARRIER -- OPTION 2
+    ACE_MeshBarrier *meshBarrier = ACE_MeshBarrier::CreateObject();
+    meshBarrier->SetName("MeshBarrier_NEW");
+    meshBarrier->SetShape(meshShape);
+
+    ACE_NavMesh *navMesh = ACE_NavMesh::CreateObject();
+    navMesh->SetName("NavMesh_NEW");
+
+    area->AddChild(meshBarrier);
+    meshBarrier->AddChild(navMesh);
+}
 
-            // Go through and add all the polys
-            for (int i = 0; i < PolyCount; ++i)
-            {
-                // Go through and add all the vertices, if they arent there already
-                // Again we assume triangles here
-                for (int j = 0; j < VertexCount; ++j)
-                {
-                    BGT_V4 point = Polys[(i*VertexCount) + j];
-
-                    // Try to locate the vertex in the mesh
-                    int vertIndex = meshShape->FindVertex(point);
-                    // If it is not there, add it
-                    if (vertIndex == -1)
-                        vertIndex = meshShape->AddVertex(point);
-                    vertIndices[j] = vertIndex;
-                }
-                // Add the finished polygon to the mesh
-                meshShape->AddPolygon(&vertIndices[0], VertexCount);
-            }
+BGT_Mesh* ACXUtilities::CreateMeshShape(const MeshBuilder &builder)
+{
+    BGT_Mesh *meshShape = BGT_Mesh::CreateObject();
 
-            // 1. GET THE EXISTENT MESHBARRIER -- OPTION 1
-            //ACE_IInventoryItem::Id barrierID = area->GetMeshBarrierId();
-            //if (barrierID == 0)
-            //{
-            //    // This makes sure the main MeshBarrier is created for the StreamedArea.
-            //    area->SetShape(NULL);
-            //    barrierID = area->GetMeshBarrierId();
-            //}
-
-            //ACE_IInventoryItem* barrierItem = area->GetInventory()->Find(barrierID);
-            //ACE_MeshBarrier *meshBarrier = (ACE_MeshBarrier*)barrierItem;
-            //meshBarrier->SetShape(meshShape);
-
-            //2. CREATE A NEW MESHBARRIER -- OPTION 2
-            ACE_MeshBarrier *meshBarrier = ACE_MeshBarrier::CreateObject();
-            meshBarrier->SetName("MeshBarrier_NEW");
-            meshBarrier->SetShape(meshShape);
-
-            ACE_NavMesh *navMesh = ACE_NavMesh::CreateObject();
-            navMesh->SetName("NavMesh_NEW");
-
-            area->AddChild(meshBarrier);
-            meshBarrier->AddChild(navMesh);
-        }
+    // The vertices keep the builder's order: its indices are the ones of the mesh
+    for (int i = 0; i < builder.NumVertices(); ++i)
+    {
+        const meshVertex &vertex = builder.Vertex(i);
+        meshShape->AddVertex(BGT_V4_STATIC_CONSTRUCT(vertex.x, vertex.y, 0, 0));
     }
+
+    // Add all the polys
+    for (int i = 0; i < builder.NumPolygons(); ++i)
+    {
+        meshShape->AddPolygon(const_cast<int *>(builder.PolygonIndices(i)), builder.PolygonSize(i));
+    }
+
+    return meshShape;
 }
 
 void ACXUtilities::CreatePathFindingCharacter()
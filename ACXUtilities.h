@@ -1,9 +1,15 @@
 #pragma once
 #include <vector>
+#include <memory>
 
 using namespace std;
 
 #include "AuxStructures.h"
+#include "OccupancyGrid.h"
+#include "RunLengthGrid.h"
+#include "AreaIndex.h"
+#include "AreaAdjacency.h"
+#include "MeshBuilder.h"
 
 #define _SILENCE_STDEXT_HASH_DEPRECATION_WARNINGS
 
@@ -12,15 +18,32 @@ using namespace std;
 class ACE_Solver;
 class ACE_StreamedArea;
 class ACE_WayPoint;
+class BGT_Mesh;
 
 class ACXUtilities {
 
 public:
     int LoadACX(const std::string path, const std::string filename, const std::string filenameBACKUP);
-    vector<vector<int>> ParseToArray();
+    OccupancyGrid ParseToArray();
+    // Same cells as ParseToArray, built row by row from the spans of the StreamedAreas
+    // (for CalculateRectangles on runs)
+    RunLengthGrid ParseToRunLengthArray();
+    // Grid over the distinct sides of the StreamedAreas instead of cellSize cells:
+    // its size depends on the number of areas, not on the size of the world.
+    // CreateNewStreamedAreas maps its rectangles back to world coordinates.
+    OccupancyGrid ParseToCompressedArray();
     void CreateNewStreamedAreas(vector<rectangle> rectangles);
-    void GenerateTessellatedMeshBarriersAndNavMeshes();
-    void CreateConnections();
+    // QUADS and TRIANGLES give the minimal polygons per area, plus the vertices
+    // the neighbours need on its sides
+    void GenerateTessellatedMeshBarriersAndNavMeshes(MeshMode mode = MeshMode::TILES);
+    // One area at a time, for rectangles that arrive one by one (RectangleGenerator).
+    ACE_StreamedArea* CreateNewStreamedArea(const rectangle &rect);
+    // sideVertices: the T-junctions of QUADS and TRIANGLES (the neighbours must be known)
+    void GenerateTessellatedMeshBarrierAndNavMesh(ACE_StreamedArea *area, MeshMode mode = MeshMode::TILES,
+        const vector<meshVertex> &sideVertices = vector<meshVertex>());
+    // Incremental: keeps the existant WayPoints and MetaConnections, and only links
+    // the areas added since LoadACX (CreateNewStreamedArea)
+    void CreateConnections(bool incremental = false);
     void CreatePathFindingCharacter();
     void ExportInventory(const std::string path, const std::string filename);
 
@@ -29,14 +52,21 @@ private:
     ACE_Solver *_mainSolver;
     ACE_Inventory _inventory;
     ACE_IInventoryItem::ItemArray _streamedAreasArray;
+    unique_ptr<AreaIndex> _areaIndex; // bounds of _streamedAreasArray, same indices
+    int _numLoadedAreas; // the first ones of _streamedAreasArray come from the ACX file
     double _cellSize;
     int _numCellsX, _numCellsY;
     BGT_V4 _initPos;
+    vector<double> _compressedXs; // lines of the compressed grid, left to right (empty if not compressed)
+    vector<double> _compressedYs; // top to bottom
 
-    ACE_StreamedArea* FindFirstStreamedAreaInPoint(BGT_V4 point, ACE_IInventoryItem::ItemArray streamedAreasArray);
-    bool PointIsIntoStreamedArea(BGT_V4 point, ACE_StreamedArea * area);
+    bool FindWorldBounds();
+    ACE_StreamedArea* FindFirstStreamedAreaInPoint(const BGT_V4 &point);
+    areaBounds StreamedAreaBounds(ACE_StreamedArea * area);
+    vector<areaBounds> RoundedStreamedAreaBounds();
     //bool AreaIsAdjacentTo(ACE_StreamedArea * area1, ACE_StreamedArea * area2);
-    void Connect2StreamedAreas(ACE_StreamedArea * area1, ACE_StreamedArea * area2);
+    void Connect2StreamedAreas(ACE_StreamedArea * area1, ACE_StreamedArea * area2, const areaBounds &segment);
+    BGT_Mesh* CreateMeshShape(const MeshBuilder &builder);
     ACE_WayPoint* CreateWayPoint(float posX, float posY, int ID, float radius);
     void CalculateInitPosAndNumCells(BGT_V4 worldSize, BGT_V4 rectanglePosition, double cellSize);
 };
@@ -0,0 +1,153 @@
+#include "AreaAdjacency.h"
+
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+static uint64_t LinkKey(int area1, int area2)
+{
+    return ((uint64_t)(uint32_t)area1 << 32) | (uint32_t)area2;
+}
+
+int LabelMapLinks(const vector<int> &labels, int width, int height, vector<areaLink> &links)
+{
+    vector<uint64_t> keys;
+    int numUnlabelled = 0;
+
+    // A boundary repeats its link on every cell along it: a vertical boundary
+    // down a column, a horizontal one along a row. Only the first is kept.
+    const uint64_t NO_KEY = ~(uint64_t)0;
+    vector<uint64_t> lastInColumn(width, NO_KEY);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const int *row = &labels[y * width];
+        const int *upperRow = (y > 0) ? row - width : NULL;
+        uint64_t lastInRow = NO_KEY;
+
+        for (int x = 0; x < width; ++x)
+        {
+            int current = row[x];
+
+            // HORIZONTAL: with the left neighbour
+            if (x > 0 && row[x - 1] != -1)
+            {
+                if (current == -1)
+                    numUnlabelled++;
+                else if (current != row[x - 1])
+                {
+                    uint64_t key = LinkKey(row[x - 1], current);
+                    if (key != lastInColumn[x])
+                        keys.push_back(key);
+                    lastInColumn[x] = key;
+                }
+            }
+
+            // VERTICAL: with the upper neighbour
+            if (upperRow != NULL && upperRow[x] != -1)
+            {
+                if (current == -1)
+                    numUnlabelled++;
+                else if (current != upperRow[x])
+                {
+                    uint64_t key = LinkKey(upperRow[x], current);
+                    if (key != lastInRow)
+                        keys.push_back(key);
+                    lastInRow = key;
+                }
+            }
+        }
+    }
+
+    // A link can still come from several boundaries: keep one of each
+    sort(keys.begin(), keys.end());
+    keys.erase(unique(keys.begin(), keys.end()), keys.end());
+
+    for (int i = 0; i < keys.size(); ++i)
+    {
+        links.push_back(areaLink((int)(keys[i] >> 32), (int)(uint32_t)keys[i]));
+    }
+    return numUnlabelled;
+}
+
+// Side of an area on a vertical (or horizontal) line: [from, to] along the line
+struct areaSide
+{
+    double line;
+    double from;
+    double to;
+    int area;
+
+    areaSide(double _line = 0, double _from = 0, double _to = 0, int _area = -1) :
+        line(_line), from(_from), to(_to), area(_area) {}
+
+    bool operator<(const areaSide &other) const
+    {
+        return line < other.line || (line == other.line && from < other.from);
+    }
+};
+
+// Sides before (left or upper areas) and after (right or lower areas) their lines.
+// On each line both lists are disjoint intervals: they are merged like two sorted lists.
+static void MergeSides(vector<areaSide> &before, vector<areaSide> &after, bool vertical, int firstNewArea, vector<areaLink> &links)
+{
+    sort(before.begin(), before.end());
+    sort(after.begin(), after.end());
+
+    int i = 0;
+    int j = 0;
+    while (i < before.size() && j < after.size())
+    {
+        const areaSide &b = before[i];
+        const areaSide &a = after[j];
+        if (b.line != a.line)
+        {
+            // Only one of them has sides on this line
+            if (b.line < a.line) i++; else j++;
+            continue;
+        }
+
+        double from = max(b.from, a.from);
+        double to = min(b.to, a.to);
+        if (from < to && max(b.area, a.area) >= firstNewArea) // a corner is not a link, and old pairs are linked already
+        {
+            areaBounds segment = vertical ? areaBounds(b.line, from, b.line, to) : areaBounds(from, b.line, to, b.line);
+            links.push_back(areaLink(b.area, a.area, segment));
+        }
+
+        // The one that ends first can't reach anything else
+        if (b.to < a.to) i++; else j++;
+    }
+}
+
+void SweepLinks(const vector<areaBounds> &areas, vector<areaLink> &links, int firstNewArea)
+{
+    int first = links.size();
+
+    // VERTICAL SEGMENTS: right side of the left area, left side of the right one
+    vector<areaSide> before;
+    vector<areaSide> after;
+    before.reserve(areas.size());
+    after.reserve(areas.size());
+    for (int i = 0; i < areas.size(); ++i)
+    {
+        before.push_back(areaSide(areas[i].maxX, areas[i].minY, areas[i].maxY, i));
+        after.push_back(areaSide(areas[i].minX, areas[i].minY, areas[i].maxY, i));
+    }
+    MergeSides(before, after, true, firstNewArea, links);
+
+    // HORIZONTAL SEGMENTS: y grows upwards, so the upper area is the one above the line
+    before.clear();
+    after.clear();
+    for (int i = 0; i < areas.size(); ++i)
+    {
+        before.push_back(areaSide(areas[i].minY, areas[i].minX, areas[i].maxX, i));
+        after.push_back(areaSide(areas[i].maxY, areas[i].minX, areas[i].maxX, i));
+    }
+    MergeSides(before, after, false, firstNewArea, links);
+
+    sort(links.begin() + first, links.end(), [](const areaLink &l1, const areaLink &l2)
+    {
+        return l1.area1 < l2.area1 || (l1.area1 == l2.area1 && l1.area2 < l2.area2);
+    });
+}
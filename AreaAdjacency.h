@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+#include "AuxStructures.h"
+#include "AreaIndex.h"
+
+// Two neighbour areas: area1 is the left or the upper one
+struct areaLink
+{
+    int area1;
+    int area2;
+    areaBounds segment; // Side they share (zero width if vertical, zero height if horizontal)
+
+    areaLink(int _area1 = -1, int _area2 = -1, areaBounds _segment = areaBounds()) :
+        area1(_area1), area2(_area2), segment(_segment) {}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// AREA ADJACENCY
+// Links between areas that touch each other.
+// LabelMapLinks works on a label map (cell -> area number, row-major, -1 where
+// there is no area): one pass compares every cell with its right and lower
+// neighbours, and the links found are deduplicated with a sorted list, so it is
+// linear in the number of cells (plus the sort of the boundaries). It is the
+// fallback for areas only known by their cells, and the reference SweepLinks is
+// tested against (tests/AreaAdjacencyTest.cpp).
+// SweepLinks works on the bounds of the areas (world coordinates, y up) and
+// also gives the shared segment: the sides are sorted by their coordinate and
+// the ones on the same line are merged, O(R log R + K) for R areas and K links,
+// whatever the size of the world. Areas must not overlap, and sides only meet
+// when their coordinates are equal (round them before).
+// Links are sorted by area1, then area2.
+////////////////////////////////////////////////////////////////////////////////
+// Returns the number of cells without area right after (or under) a cell with one.
+// The segments are left empty.
+int LabelMapLinks(const vector<int> &labels, int width, int height, vector<areaLink> &links);
+
+// Only the links with an area from firstNewArea on (the ones added since the links were made)
+void SweepLinks(const vector<areaBounds> &areas, vector<areaLink> &links, int firstNewArea = 0);
@@ -0,0 +1,85 @@
+#include "AreaIndex.h"
+
+#include <math.h>
+#include <algorithm>
+using namespace std;
+
+int LinearAreaIndex::Add(const areaBounds &bounds)
+{
+    _areas.push_back(bounds);
+    return (int)_areas.size() - 1;
+}
+
+int LinearAreaIndex::FindFirst(double x, double y) const
+{
+    for (int i = 0; i < _areas.size(); ++i)
+    {
+        if (_areas[i].Contains(x, y))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+BucketGridAreaIndex::BucketGridAreaIndex(const areaBounds &world, double bucketSize) :
+    _world(world), _bucketSize(bucketSize)
+{
+    _numBucketsX = max(1, (int)ceil((world.maxX - world.minX) / bucketSize));
+    _numBucketsY = max(1, (int)ceil((world.maxY - world.minY) / bucketSize));
+    _buckets.resize(_numBucketsX * _numBucketsY);
+}
+
+int BucketGridAreaIndex::Add(const areaBounds &bounds)
+{
+    int index = (int)_areas.size();
+    _areas.push_back(bounds);
+
+    // Numbers only grow: every bucket stays sorted
+    int x0 = BucketX(bounds.minX);
+    int x1 = BucketX(bounds.maxX);
+    int y0 = BucketY(bounds.minY);
+    int y1 = BucketY(bounds.maxY);
+    for (int by = y0; by <= y1; ++by)
+    {
+        for (int bx = x0; bx <= x1; ++bx)
+        {
+            _buckets[by * _numBucketsX + bx].push_back(index);
+        }
+    }
+    return index;
+}
+
+int BucketGridAreaIndex::FindFirst(double x, double y) const
+{
+    const vector<int> &bucket = _buckets[BucketY(y) * _numBucketsX + BucketX(x)];
+    for (int i = 0; i < bucket.size(); ++i)
+    {
+        if (_areas[bucket[i]].Contains(x, y))
+        {
+            return bucket[i];
+        }
+    }
+    return -1;
+}
+
+void BucketGridAreaIndex::Clear()
+{
+    _areas.clear();
+    for (int i = 0; i < _buckets.size(); ++i)
+    {
+        _buckets[i].clear();
+    }
+}
+
+int BucketGridAreaIndex::BucketX(double x) const
+{
+    int bucket = (int)floor((x - _world.minX) / _bucketSize);
+    return min(max(bucket, 0), _numBucketsX - 1);
+}
+
+int BucketGridAreaIndex::BucketY(double y) const
+{
+    int bucket = (int)floor((y - _world.minY) / _bucketSize);
+    return min(max(bucket, 0), _numBucketsY - 1);
+}
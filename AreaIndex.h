@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+// Axis-aligned bounds of an area, in world coordinates (both sides included)
+struct areaBounds
+{
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+
+    areaBounds(double _minX = 0, double _minY = 0, double _maxX = 0, double _maxY = 0) :
+        minX(_minX), minY(_minY), maxX(_maxX), maxY(_maxY) {}
+
+    bool Contains(double x, double y) const
+    {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// AREA INDEX
+// Point queries over a growing list of area bounds. Areas are numbered in the
+// order they are added, and FindFirst returns the lowest number that contains
+// the point (-1 if none), the same area a scan of the list would find first.
+// It knows nothing about AI.Implant: ACXUtilities keeps the numbers equal to
+// the indices of its StreamedArea array.
+////////////////////////////////////////////////////////////////////////////////
+class AreaIndex {
+
+public:
+    virtual ~AreaIndex() {}
+
+    // Returns the number given to the area
+    virtual int Add(const areaBounds &bounds) = 0;
+    virtual int FindFirst(double x, double y) const = 0;
+    virtual int Size() const = 0;
+    virtual void Clear() = 0;
+};
+
+// Reference stand-in: tests every area. Plain memory, no AI.Implant: the bucket
+// grid is checked and benchmarked against it (tests/AreaIndexTest.cpp).
+class LinearAreaIndex : public AreaIndex {
+
+public:
+    virtual int Add(const areaBounds &bounds);
+    virtual int FindFirst(double x, double y) const;
+    virtual int Size() const { return (int)_areas.size(); }
+    virtual void Clear() { _areas.clear(); }
+
+private:
+    vector<areaBounds> _areas;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// BUCKET GRID AREA INDEX
+// Uniform grid of buckets over the world; every bucket lists (in ascending
+// order) the areas that touch it, so a query only tests the areas of its own
+// bucket. Areas and points out of the world are clamped to the border buckets.
+////////////////////////////////////////////////////////////////////////////////
+class BucketGridAreaIndex : public AreaIndex {
+
+public:
+    BucketGridAreaIndex(const areaBounds &world, double bucketSize);
+
+    virtual int Add(const areaBounds &bounds);
+    virtual int FindFirst(double x, double y) const;
+    virtual int Size() const { return (int)_areas.size(); }
+    virtual void Clear();
+
+private:
+    areaBounds _world;
+    double _bucketSize;
+    int _numBucketsX, _numBucketsY;
+    vector<areaBounds> _areas;
+    vector<vector<int>> _buckets; // row-major
+
+    int BucketX(double x) const;
+    int BucketY(double y) const;
+};
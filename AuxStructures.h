@@ -19,4 +19,26 @@ struct rectangle
 
     rectangle(coord2D _c1 = coord2D(), coord2D _c2 = coord2D()) :
         corner1(_c1), corner2(_c2) {}
+};
+
+// Horizontal or vertical segment between two lattice vertices.
+// Lattice vertex (x, y) is the upper-left corner of the cell (x, y).
+struct chord
+{
+    coord2D from; // Upper or left end
+    coord2D to;   // Lower or right end
+
+    chord(coord2D _from = coord2D(), coord2D _to = coord2D()) :
+        from(_from), to(_to) {}
+};
+
+// Horizontal run of blank cells, from x0 to x1 (both included) in the row y
+struct blankRun
+{
+    int y;
+    int x0;
+    int x1;
+
+    blankRun(int _y = 0, int _x0 = 0, int _x1 = 0) :
+        y(_y), x0(_x0), x1(_x1) {}
 };
\ No newline at end of file
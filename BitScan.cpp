@@ -0,0 +1,169 @@
+#include "BitScan.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BITSCAN_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(BITSCAN_HAS_AVX2) && !defined(_MSC_VER)
+#define BITSCAN_TARGET_AVX2 __attribute__((target("avx2,bmi")))
+#else
+#define BITSCAN_TARGET_AVX2
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// SCALAR FALLBACK
+////////////////////////////////////////////////////////////////////////////////
+static int FindNextOccupiedScalar(const uint64_t *row, int numWords, int x)
+{
+    int w = x >> 6;
+    if (w >= numWords)
+    {
+        return numWords * 64;
+    }
+
+    // First word: ignore the cells before x
+    uint64_t word = row[w] & ~((1ULL << (x & 63)) - 1);
+    while (word == 0)
+    {
+        if (++w == numWords)
+            return numWords * 64;
+        word = row[w];
+    }
+    return w * 64 + TrailingZeros64(word);
+}
+
+static bool SpanIsFreeScalar(const uint64_t *row, int x0, int x1)
+{
+    int firstWord = x0 >> 6;
+    int lastWord = x1 >> 6;
+    if (firstWord == lastWord)
+    {
+        return (row[firstWord] & WordMask(x0 & 63, x1 & 63)) == 0;
+    }
+
+    if ((row[firstWord] & WordMask(x0 & 63, 63)) != 0 ||
+        (row[lastWord] & WordMask(0, x1 & 63)) != 0)
+    {
+        return false;
+    }
+    for (int w = firstWord + 1; w < lastWord; ++w)
+    {
+        if (row[w] != 0)
+            return false;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2 (4 words per step, tzcnt for the bit position)
+////////////////////////////////////////////////////////////////////////////////
+#ifdef BITSCAN_HAS_AVX2
+BITSCAN_TARGET_AVX2
+static int FindNextOccupiedAvx2(const uint64_t *row, int numWords, int x)
+{
+    int w = x >> 6;
+    if (w >= numWords)
+    {
+        return numWords * 64;
+    }
+
+    uint64_t first = row[w] & ~((1ULL << (x & 63)) - 1);
+    if (first != 0)
+    {
+        return w * 64 + (int)_tzcnt_u64(first);
+    }
+
+    // Skip blocks of 4 blank words, then finish word by word
+    for (++w; w + 4 <= numWords; w += 4)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(row + w));
+        if (!_mm256_testz_si256(block, block))
+            break;
+    }
+    for (; w < numWords; ++w)
+    {
+        if (row[w] != 0)
+            return w * 64 + (int)_tzcnt_u64(row[w]);
+    }
+    return numWords * 64;
+}
+
+BITSCAN_TARGET_AVX2
+static bool SpanIsFreeAvx2(const uint64_t *row, int x0, int x1)
+{
+    int firstWord = x0 >> 6;
+    int lastWord = x1 >> 6;
+    if (firstWord == lastWord)
+    {
+        return (row[firstWord] & WordMask(x0 & 63, x1 & 63)) == 0;
+    }
+
+    if ((row[firstWord] & WordMask(x0 & 63, 63)) != 0 ||
+        (row[lastWord] & WordMask(0, x1 & 63)) != 0)
+    {
+        return false;
+    }
+
+    int w = firstWord + 1;
+    for (; w + 4 <= lastWord; w += 4)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(row + w));
+        if (!_mm256_testz_si256(block, block))
+            return false;
+    }
+    for (; w < lastWord; ++w)
+    {
+        if (row[w] != 0)
+            return false;
+    }
+    return true;
+}
+
+static bool CpuSupportsAvx2()
+{
+#ifdef _MSC_VER
+    // AVX2 + BMI1 in the CPU, and the YMM state enabled by the OS
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    bool bmi1 = (info[1] & (1 << 3)) != 0;
+    return avx2 && bmi1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+#endif
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// SELECTION
+////////////////////////////////////////////////////////////////////////////////
+static BitScanKernels SelectBitScanKernels()
+{
+    BitScanKernels scalar = { "scalar", FindNextOccupiedScalar, SpanIsFreeScalar };
+#ifdef BITSCAN_HAS_AVX2
+    if (CpuSupportsAvx2())
+    {
+        BitScanKernels avx2 = { "avx2", FindNextOccupiedAvx2, SpanIsFreeAvx2 };
+        return avx2;
+    }
+#endif
+    return scalar;
+}
+
+const BitScanKernels &GetBitScanKernels()
+{
+    static const BitScanKernels selectedKernels = SelectBitScanKernels();
+    return selectedKernels;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// BIT HELPERS
+////////////////////////////////////////////////////////////////////////////////
+inline int PopCount64(uint64_t word)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt64(word);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+// word must not be 0
+inline int TrailingZeros64(uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Bits [first, last] of a word set to 1
+inline uint64_t WordMask(int first, int last)
+{
+    uint64_t upTo = (last == 63) ? ~0ULL : ((1ULL << (last + 1)) - 1);
+    return upTo & ~((1ULL << first) - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ROW SCAN KERNELS
+// They work on one packed row of an OccupancyGrid (1 = occupied), a word at a
+// time. There is an AVX2 version and a scalar fallback; the best one for the
+// running CPU is selected once, at start-up.
+////////////////////////////////////////////////////////////////////////////////
+
+// x of the first occupied cell at or after x (numWords * 64 when there is none)
+typedef int (*FindNextOccupiedFunc)(const uint64_t *row, int numWords, int x);
+// true when every cell in [x0, x1] is blank
+typedef bool (*SpanIsFreeFunc)(const uint64_t *row, int x0, int x1);
+
+struct BitScanKernels
+{
+    const char *name;
+    FindNextOccupiedFunc FindNextOccupied;
+    SpanIsFreeFunc SpanIsFree;
+};
+
+const BitScanKernels &GetBitScanKernels();
@@ -0,0 +1,278 @@
+#include "BranchAndBound.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <memory>
+using namespace std;
+
+// The table of a search stops growing past this number of states
+static const int MAX_TRANSPOSITIONS = 1 << 22;
+// Levels of the tree split into tasks when solving in parallel
+static const int PARALLEL_SPLIT_DEPTH = 3;
+// Nodes a search counts privately before adding them to the shared counter
+static const int NODE_COUNT_BATCH = 256;
+
+BranchAndBoundSolver::BranchAndBoundSolver(const OccupancyGrid &grid, long long maxNodes) :
+    _bestCost(INT_MAX), _numNodes(0), _maxNodes(maxNodes), _aborted(false),
+    _pool(NULL), _tasks(NULL), _splitDepth(0)
+{
+    _root.grid = grid;
+    _root.hash = 0;
+    _root.numCorners = 0;
+    _root.numUncountedNodes = 0;
+
+    // CANDIDATE LINES: through the corners of the original area
+    _cornerColumn.assign(grid.Width() + 1, false);
+    _cornerRow.assign(grid.Height() + 1, false);
+    for (int vy = 0; vy <= grid.Height(); ++vy)
+    {
+        for (int vx = 0; vx <= grid.Width(); ++vx)
+        {
+            int numCorners = CornersAroundVertex(grid, vx, vy);
+            _root.numCorners += numCorners;
+            if (numCorners > 0)
+            {
+                _cornerColumn[vx] = true;
+                _cornerRow[vy] = true;
+            }
+        }
+    }
+
+    // ZOBRIST KEYS (fixed seed: same search for the same grid)
+    mt19937_64 random(0x5EED);
+    _zobristKeys.resize(grid.Width() * grid.Height());
+    for (int i = 0; i < _zobristKeys.size(); ++i)
+    {
+        _zobristKeys[i] = random();
+    }
+}
+
+void BranchAndBoundSolver::SetIncumbent(const vector<rectangle> &solution)
+{
+    UpdateBest(solution);
+}
+
+bool BranchAndBoundSolver::Solve(vector<rectangle> &solution, int numThreads)
+{
+    if (numThreads == 1)
+    {
+        Search(_root, coord2D(0, 0));
+    }
+    else
+    {
+        // Called from a pool task (tiles, components...): its pool runs the subtrees too
+        SharedPool pool(numThreads);
+        TaskGroup tasks;
+        _pool = &*pool;
+        _tasks = &tasks;
+        _splitDepth = PARALLEL_SPLIT_DEPTH;
+
+        Search(_root, coord2D(0, 0));
+        pool->Wait(tasks);
+
+        _pool = NULL;
+        _tasks = NULL;
+        _splitDepth = 0;
+    }
+    _numNodes += _root.numUncountedNodes;
+    _root.numUncountedNodes = 0;
+
+    solution.insert(solution.end(), _best.begin(), _best.end());
+    return !_aborted;
+}
+
+void BranchAndBoundSolver::Search(SearchState &state, const coord2D &_from)
+{
+    if (!CountNode(state))
+        return;
+
+    // Everything before _from is occupied yet (the anchors only move forward)
+    coord2D anchor;
+    if (!state.grid.FindFirstBlank(_from, anchor))
+    {
+        // IsFinalSolution
+        UpdateBest(state.current);
+        return;
+    }
+
+    // BOUND
+    int currentCost = state.current.size();
+    if (currentCost + (state.numCorners + 3) / 4 >= _bestCost)
+        return;
+
+    // MEMOIZATION: this same grid reached before with fewer (or as many) rectangles
+    unordered_map<uint64_t, int>::iterator seen = state.transpositions.find(state.hash);
+    if (seen != state.transpositions.end())
+    {
+        if (seen->second <= currentCost)
+            return;
+        seen->second = currentCost;
+    }
+    else if (state.transpositions.size() < MAX_TRANSPOSITIONS)
+    {
+        state.transpositions[state.hash] = currentCost;
+    }
+
+    // BRANCH: rectangles with the anchor as upper-left corner
+    vector<rectangle> options;
+    int maxRight = state.grid.FindNextOccupiedInRow(anchor.x, anchor.y) - 1;
+    int maxBottom = state.grid.Height() - 1;
+    for (int right = anchor.x; right <= maxRight; ++right)
+    {
+        // Wider rectangles can't go further down than the narrower ones
+        int bottom = anchor.y;
+        while (bottom < maxBottom && state.grid.RowSpanIsFree(bottom + 1, anchor.x, right))
+        {
+            bottom++;
+        }
+        maxBottom = bottom;
+
+        if (!_cornerColumn[right + 1])
+            continue;
+
+        for (int y = anchor.y; y <= maxBottom; ++y)
+        {
+            if (_cornerRow[y + 1])
+            {
+                options.push_back(rectangle(anchor, coord2D(right, y)));
+            }
+        }
+    }
+
+    // Biggest first: good solutions (and tighter pruning) early
+    sort(options.begin(), options.end(), [](const rectangle &a, const rectangle &b)
+    {
+        return (a.corner2.x - a.corner1.x + 1) * (a.corner2.y - a.corner1.y + 1) >
+               (b.corner2.x - b.corner1.x + 1) * (b.corner2.y - b.corner1.y + 1);
+    });
+
+    for (int i = 0; i < options.size() && !_aborted; ++i)
+    {
+        if (currentCost + 1 >= _bestCost) // nothing better can come from here
+            break;
+
+        if (currentCost < _splitDepth)
+        {
+            SpawnSubtree(state, options[i], anchor);
+            continue;
+        }
+
+        Place(state, options[i], true);
+        state.current.push_back(options[i]);
+
+        Search(state, anchor);
+
+        // UNDO
+        state.current.pop_back();
+        Place(state, options[i], false);
+    }
+}
+
+void BranchAndBoundSolver::SpawnSubtree(const SearchState &state, const rectangle &option, const coord2D &anchor)
+{
+    // The subtree gets its own grid; its table starts empty (the states above it
+    // can't show up again below)
+    shared_ptr<SearchState> subtree(new SearchState());
+    subtree->grid = state.grid;
+    subtree->hash = state.hash;
+    subtree->numCorners = state.numCorners;
+    subtree->current = state.current;
+    subtree->numUncountedNodes = 0;
+
+    Place(*subtree, option, true);
+    subtree->current.push_back(option);
+
+    _pool->Submit([this, subtree, anchor]()
+    {
+        Search(*subtree, anchor);
+        _numNodes += subtree->numUncountedNodes;
+    }, _tasks);
+}
+
+bool BranchAndBoundSolver::CountNode(SearchState &state)
+{
+    if (_aborted)
+        return false;
+
+    if (++state.numUncountedNodes == NODE_COUNT_BATCH)
+    {
+        state.numUncountedNodes = 0;
+        if ((_numNodes += NODE_COUNT_BATCH) > _maxNodes)
+        {
+            _aborted = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+void BranchAndBoundSolver::UpdateBest(const vector<rectangle> &solution)
+{
+    lock_guard<mutex> guard(_bestLock);
+    if (solution.size() < _bestCost)
+    {
+        _best = solution;
+        _bestCost = solution.size();
+    }
+}
+
+void BranchAndBoundSolver::Place(SearchState &state, const rectangle &rect, bool occupied)
+{
+    // Only the vertices on the border of the rectangle can change their corners
+    state.numCorners -= CornersOnBorder(state.grid, rect);
+    state.grid.SetRectangle(rect.corner1, rect.corner2, occupied);
+    state.numCorners += CornersOnBorder(state.grid, rect);
+
+    for (int y = rect.corner1.y; y <= rect.corner2.y; ++y)
+    {
+        for (int x = rect.corner1.x; x <= rect.corner2.x; ++x)
+        {
+            state.hash ^= _zobristKeys[y * state.grid.Width() + x];
+        }
+    }
+}
+
+int BranchAndBoundSolver::CornersOnBorder(const OccupancyGrid &grid, const rectangle &rect) const
+{
+    int x0 = rect.corner1.x;
+    int y0 = rect.corner1.y;
+    int x1 = rect.corner2.x + 1;
+    int y1 = rect.corner2.y + 1;
+
+    int numCorners = 0;
+    for (int vx = x0; vx <= x1; ++vx)
+    {
+        numCorners += CornersAroundVertex(grid, vx, y0) + CornersAroundVertex(grid, vx, y1);
+    }
+    for (int vy = y0 + 1; vy < y1; ++vy)
+    {
+        numCorners += CornersAroundVertex(grid, x0, vy) + CornersAroundVertex(grid, x1, vy);
+    }
+    return numCorners;
+}
+
+int BranchAndBoundSolver::CornersAroundVertex(const OccupancyGrid &grid, int vx, int vy) const
+{
+    // Rectangle corners needed at this vertex of the lattice:
+    //  1 or 3 blanks around (convex or concave corner)   -> 1
+    //  2 blanks touching only by the vertex (diagonal)   -> 2
+    bool nw = CellIsBlank(grid, vx - 1, vy - 1);
+    bool ne = CellIsBlank(grid, vx, vy - 1);
+    bool sw = CellIsBlank(grid, vx - 1, vy);
+    bool se = CellIsBlank(grid, vx, vy);
+    int numBlanks = nw + ne + sw + se;
+    if (numBlanks == 1 || numBlanks == 3)
+        return 1;
+    if (numBlanks == 2 && nw == se)
+        return 2;
+    return 0;
+}
+
+bool BranchAndBoundSolver::CellIsBlank(const OccupancyGrid &grid, int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= grid.Width() || y >= grid.Height())
+        return false;
+    return !grid.IsOccupied(x, y);
+}
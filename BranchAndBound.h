@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+
+#include "AuxStructures.h"
+#include "OccupancyGrid.h"
+
+class ThreadPool;
+class TaskGroup;
+
+////////////////////////////////////////////////////////////////////////////////
+// BRANCH AND BOUND EXACT SEARCH
+//
+// - Branching: the first blank (row-major) can only be the upper-left corner of
+//   its rectangle. Every rectangle starting there is a branch, but only with its
+//   right and bottom edges on a line through a corner of the original area:
+//   some optimal partition only uses those lines, so nothing is lost.
+// - Bound: every corner of the blank area is a corner of some rectangle, and a
+//   rectangle has 4 corners, so at least ceil(corners / 4) rectangles are left.
+// - Memoization: a transposition table keyed by a Zobrist hash of the grid,
+//   with the fewest rectangles each state has been reached with.
+// - Every mark is undone when backtracking.
+// The search stops after maxNodes nodes, keeping the best solution found.
+//
+// In parallel the subtrees of the first levels become tasks of a work-stealing
+// pool. Each one searches on its own copy of the grid; the best cost is shared
+// through an atomic so every task prunes against the global best.
+////////////////////////////////////////////////////////////////////////////////
+class BranchAndBoundSolver {
+
+public:
+    BranchAndBoundSolver(const OccupancyGrid &grid, long long maxNodes);
+
+    // Known solution to prune against from the start (e.g. the greedy one)
+    void SetIncumbent(const vector<rectangle> &solution);
+
+    // Returns true when the solution is proven optimal (the search wasn't cut).
+    // numThreads <= 0 uses all the cores.
+    bool Solve(vector<rectangle> &solution, int numThreads = 1);
+    long long NumNodes() const { return _numNodes; }
+
+private:
+    // Everything a search modifies: private to the task exploring a subtree
+    struct SearchState
+    {
+        OccupancyGrid grid;
+        uint64_t hash;
+        int numCorners;                 // corners of the blank area left
+        vector<rectangle> current;
+        unordered_map<uint64_t, int> transpositions;
+        int numUncountedNodes;
+    };
+
+    // Read-only during the search
+    vector<bool> _cornerColumn; // lattice x with a corner of the original area
+    vector<bool> _cornerRow;    // lattice y with a corner of the original area
+    vector<uint64_t> _zobristKeys;
+    SearchState _root;
+
+    // Shared by all the tasks
+    atomic<int> _bestCost;
+    mutex _bestLock;
+    vector<rectangle> _best;
+    atomic<long long> _numNodes;
+    long long _maxNodes;
+    atomic<bool> _aborted;
+
+    ThreadPool *_pool;
+    TaskGroup *_tasks;
+    int _splitDepth;
+
+    void Search(SearchState &state, const coord2D &_from);
+    void SpawnSubtree(const SearchState &state, const rectangle &option, const coord2D &anchor);
+    bool CountNode(SearchState &state);
+    void UpdateBest(const vector<rectangle> &solution);
+    void Place(SearchState &state, const rectangle &rect, bool occupied);
+    int CornersOnBorder(const OccupancyGrid &grid, const rectangle &rect) const;
+    int CornersAroundVertex(const OccupancyGrid &grid, int vx, int vy) const;
+    bool CellIsBlank(const OccupancyGrid &grid, int x, int y) const;
+};
@@ -0,0 +1,92 @@
+#include "ConnectedComponents.h"
+
+#include <algorithm>
+using namespace std;
+
+ConnectedComponents::ConnectedComponents(const OccupancyGrid &grid)
+{
+    // 1. BLANK RUNS OF EACH ROW, joined with the ones they touch in the row above
+    vector<blankRun> runs;
+    vector<int> parents;
+    int previousRowStart = 0;
+    for (int y = 0; y < grid.Height(); ++y)
+    {
+        int rowStart = runs.size();
+        coord2D blank;
+        int x = 0;
+        while (x < grid.Width() && grid.FindFirstBlank(coord2D(x, y), blank) && blank.y == y)
+        {
+            int x1 = grid.FindNextOccupiedInRow(blank.x, y) - 1;
+            runs.push_back(blankRun(y, blank.x, x1));
+            parents.push_back(runs.size() - 1);
+            x = x1 + 1;
+        }
+
+        // Both rows are sorted by x: walk them together
+        int above = previousRowStart;
+        for (int r = rowStart; r < runs.size(); ++r)
+        {
+            while (above < rowStart && runs[above].x1 < runs[r].x0)
+            {
+                above++;
+            }
+            for (int a = above; a < rowStart && runs[a].x0 <= runs[r].x1; ++a)
+            {
+                int rootA = FindRoot(parents, a);
+                int rootR = FindRoot(parents, r);
+                if (rootA != rootR)
+                {
+                    // The oldest run stays as root
+                    parents[max(rootA, rootR)] = min(rootA, rootR);
+                }
+            }
+        }
+        previousRowStart = rowStart;
+    }
+
+    // 2. GROUP THE RUNS (a component's root is its first run)
+    vector<int> componentOfRoot(runs.size(), -1);
+    for (int r = 0; r < runs.size(); ++r)
+    {
+        int root = FindRoot(parents, r);
+        if (componentOfRoot[root] == -1)
+        {
+            componentOfRoot[root] = _components.size();
+            _components.push_back(gridComponent());
+            _components.back().boundingBox = rectangle(coord2D(runs[r].x0, runs[r].y), coord2D(runs[r].x1, runs[r].y));
+        }
+
+        gridComponent &component = _components[componentOfRoot[root]];
+        component.runs.push_back(runs[r]);
+        component.numCells += runs[r].x1 - runs[r].x0 + 1;
+        component.boundingBox.corner1.x = min(component.boundingBox.corner1.x, runs[r].x0);
+        component.boundingBox.corner2.x = max(component.boundingBox.corner2.x, runs[r].x1);
+        component.boundingBox.corner2.y = runs[r].y;
+    }
+}
+
+OccupancyGrid ConnectedComponents::ExtractGrid(int index) const
+{
+    const gridComponent &component = _components[index];
+    const coord2D &origin = component.boundingBox.corner1;
+
+    OccupancyGrid grid(component.boundingBox.corner2.x - origin.x + 1, component.boundingBox.corner2.y - origin.y + 1);
+    grid.SetRectangle(coord2D(0, 0), coord2D(grid.Width() - 1, grid.Height() - 1), true);
+    for (int r = 0; r < component.runs.size(); ++r)
+    {
+        const blankRun &run = component.runs[r];
+        grid.SetRectangle(coord2D(run.x0 - origin.x, run.y - origin.y), coord2D(run.x1 - origin.x, run.y - origin.y), false);
+    }
+    return grid;
+}
+
+int ConnectedComponents::FindRoot(vector<int> &parents, int run)
+{
+    // With path halving
+    while (parents[run] != run)
+    {
+        parents[run] = parents[parents[run]];
+        run = parents[run];
+    }
+    return run;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+#include "AuxStructures.h"
+#include "OccupancyGrid.h"
+
+struct gridComponent
+{
+    rectangle boundingBox;
+    vector<blankRun> runs; // row-major order
+    int numCells;
+
+    gridComponent() :
+        numCells(0) {}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// CONNECTED COMPONENTS
+// Blank areas connected through their sides (4-neighbourhood). They are found
+// with a union-find over the blank runs of each row, so the memory depends on
+// the number of runs, not cells.
+// Components are numbered in row-major order of their first cell.
+////////////////////////////////////////////////////////////////////////////////
+class ConnectedComponents {
+
+public:
+    explicit ConnectedComponents(const OccupancyGrid &grid);
+
+    int Size() const { return (int)_components.size(); }
+    const gridComponent &operator[](int index) const { return _components[index]; }
+
+    // Grid over the bounding box of the component: only its own cells are blank
+    OccupancyGrid ExtractGrid(int index) const;
+
+private:
+    vector<gridComponent> _components;
+
+    int FindRoot(vector<int> &parents, int run);
+};
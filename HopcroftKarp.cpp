@@ -0,0 +1,165 @@
+#include "HopcroftKarp.h"
+
+#include <climits>
+#include <queue>
+using namespace std;
+
+HopcroftKarp::HopcroftKarp(int numLeft, int numRight) :
+    _numLeft(numLeft), _numRight(numRight),
+    _adjacency(numLeft), _matchLeft(numLeft, -1), _matchRight(numRight, -1),
+    _dist(numLeft), _nextEdge(numLeft) {}
+
+void HopcroftKarp::AddEdge(int left, int right)
+{
+    _adjacency[left].push_back(right);
+}
+
+int HopcroftKarp::MaximumMatching()
+{
+    int matchingSize = 0;
+    while (BuildLayers())
+    {
+        for (int u = 0; u < _numLeft; ++u)
+        {
+            _nextEdge[u] = 0;
+        }
+        for (int u = 0; u < _numLeft; ++u)
+        {
+            if (_matchLeft[u] == -1 && Augment(u))
+            {
+                matchingSize++;
+            }
+        }
+    }
+    return matchingSize;
+}
+
+void HopcroftKarp::MaximumIndependentSet(vector<bool> &leftInSet, vector<bool> &rightInSet)
+{
+    // Alternating search from every free left vertex: left->right through
+    // non-matching edges, right->left through matching edges.
+    // Min vertex cover = (Left NOT visited) + (Right visited); the MIS is its complement.
+    vector<bool> visitedLeft(_numLeft, false);
+    vector<bool> visitedRight(_numRight, false);
+    queue<int> pending;
+
+    for (int u = 0; u < _numLeft; ++u)
+    {
+        if (_matchLeft[u] == -1)
+        {
+            visitedLeft[u] = true;
+            pending.push(u);
+        }
+    }
+
+    while (!pending.empty())
+    {
+        int u = pending.front();
+        pending.pop();
+        for (int i = 0; i < _adjacency[u].size(); ++i)
+        {
+            int v = _adjacency[u][i];
+            if (visitedRight[v] || _matchLeft[u] == v)
+                continue;
+
+            visitedRight[v] = true;
+            int w = _matchRight[v];
+            if (w != -1 && !visitedLeft[w])
+            {
+                visitedLeft[w] = true;
+                pending.push(w);
+            }
+        }
+    }
+
+    leftInSet = visitedLeft;
+    rightInSet.assign(_numRight, false);
+    for (int v = 0; v < _numRight; ++v)
+    {
+        rightInSet[v] = !visitedRight[v];
+    }
+}
+
+bool HopcroftKarp::BuildLayers()
+{
+    // BFS from the free left vertices. Returns true if any free right vertex is reachable.
+    queue<int> pending;
+    for (int u = 0; u < _numLeft; ++u)
+    {
+        if (_matchLeft[u] == -1)
+        {
+            _dist[u] = 0;
+            pending.push(u);
+        }
+        else
+        {
+            _dist[u] = INT_MAX;
+        }
+    }
+
+    bool foundFree = false;
+    while (!pending.empty())
+    {
+        int u = pending.front();
+        pending.pop();
+        for (int i = 0; i < _adjacency[u].size(); ++i)
+        {
+            int w = _matchRight[_adjacency[u][i]];
+            if (w == -1)
+            {
+                foundFree = true;
+            }
+            else if (_dist[w] == INT_MAX)
+            {
+                _dist[w] = _dist[u] + 1;
+                pending.push(w);
+            }
+        }
+    }
+    return foundFree;
+}
+
+bool HopcroftKarp::Augment(int root)
+{
+    // Layered DFS with an explicit stack (augmenting paths can be as long as the
+    // number of chords, far too deep for recursion on big grids).
+    _stack.clear();
+    _stack.push_back(root);
+
+    while (!_stack.empty())
+    {
+        int u = _stack.back();
+        if (_nextEdge[u] == _adjacency[u].size())
+        {
+            // Dead end: never visit it again in this phase
+            _dist[u] = INT_MAX;
+            _stack.pop_back();
+            continue;
+        }
+
+        int v = _adjacency[u][_nextEdge[u]];
+        int w = _matchRight[v];
+        if (w == -1)
+        {
+            // Flip the whole path stored in the stack
+            for (int i = (int)_stack.size() - 1; i >= 0; --i)
+            {
+                int pathLeft = _stack[i];
+                int pathRight = _adjacency[pathLeft][_nextEdge[pathLeft]];
+                _matchLeft[pathLeft] = pathRight;
+                _matchRight[pathRight] = pathLeft;
+            }
+            return true;
+        }
+
+        if (_dist[u] != INT_MAX && _dist[w] == _dist[u] + 1)
+        {
+            _stack.push_back(w);
+        }
+        else
+        {
+            _nextEdge[u]++;
+        }
+    }
+    return false;
+}
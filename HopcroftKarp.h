@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+// MAXIMUM BIPARTITE MATCHING (Hopcroft-Karp)
+//
+// Left and right vertices are numbered from 0. Once MaximumMatching() has run,
+// MaximumIndependentSet() derives the complement of a minimum vertex cover
+// (Konig's theorem).
+////////////////////////////////////////////////////////////////////////////////
+class HopcroftKarp {
+
+public:
+    HopcroftKarp(int numLeft, int numRight);
+
+    void AddEdge(int left, int right);
+    int MaximumMatching();
+    void MaximumIndependentSet(vector<bool> &leftInSet, vector<bool> &rightInSet);
+
+private:
+    int _numLeft;
+    int _numRight;
+    vector<vector<int>> _adjacency;
+    vector<int> _matchLeft;
+    vector<int> _matchRight;
+    vector<int> _dist;
+    vector<int> _nextEdge;
+    vector<int> _stack;
+
+    bool BuildLayers();
+    bool Augment(int root);
+};
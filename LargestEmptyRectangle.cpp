@@ -0,0 +1,170 @@
+#include "LargestEmptyRectangle.h"
+#include "BitScan.h"
+
+#include <algorithm>
+using namespace std;
+
+LargestEmptyRectangles::LargestEmptyRectangles(const OccupancyGrid &grid) :
+    _width(grid.Width()), _height(grid.Height()), _grid(grid)
+{
+    _heights.assign(_width, 0);
+    _rowBest.resize(_height);
+    _rowBestArea.assign(_height, 0);
+    for (int y = 0; y < _height; ++y)
+    {
+        AdvanceHeights(y);
+        ScanRow(y);
+    }
+}
+
+bool LargestEmptyRectangles::Next(rectangle &rect)
+{
+    while (!_candidates.empty())
+    {
+        pair<int, int> top = _candidates.top();
+        _candidates.pop();
+
+        int y = -top.second;
+        if (top.first != _rowBestArea[y])
+            continue; // stale: the row has been scanned again since
+
+        rect = _rowBest[y];
+        Carve(rect);
+        return true;
+    }
+    return false;
+}
+
+void LargestEmptyRectangles::ScanRow(int y)
+{
+    // Largest rectangle in the histogram of the row (monotonic stack of columns)
+    const int *heights = _heights.data();
+    int bestArea = 0;
+    rectangle best;
+
+    _stack.clear();
+    for (int x = 0; x <= _width; ++x)
+    {
+        int h = (x < _width) ? heights[x] : 0;
+        while (!_stack.empty() && heights[_stack.back()] >= h)
+        {
+            int barHeight = heights[_stack.back()];
+            _stack.pop_back();
+            int left = _stack.empty() ? 0 : _stack.back() + 1;
+            int area = barHeight * (x - left);
+            if (area > bestArea)
+            {
+                bestArea = area;
+                best = rectangle(coord2D(left, y - barHeight + 1), coord2D(x - 1, y));
+            }
+        }
+        _stack.push_back(x);
+    }
+
+    _rowBest[y] = best;
+    _rowBestArea[y] = bestArea;
+    if (bestArea > 0)
+    {
+        _candidates.push(make_pair(bestArea, -y));
+    }
+}
+
+void LargestEmptyRectangles::LoadHeights(int y)
+{
+    // Every column is followed up until its first occupied cell: a word of columns
+    // is done once all of them have found it
+    const OccupancyGrid &grid = _grid;
+    int numWords = grid.WordsPerRow();
+    _blankColumns.assign(numWords, ~(uint64_t)0);
+    int numOpenWords = numWords;
+    for (int r = y; r >= 0 && numOpenWords > 0; --r)
+    {
+        const uint64_t *row = grid.Row(r);
+        for (int w = 0; w < numWords; ++w)
+        {
+            uint64_t ended = _blankColumns[w] & row[w];
+            if (ended == 0)
+                continue;
+
+            _blankColumns[w] &= ~ended;
+            if (_blankColumns[w] == 0)
+                numOpenWords--;
+            for (; ended != 0; ended &= ended - 1)
+            {
+                int x = w * 64 + TrailingZeros64(ended);
+                if (x < _width) // padding bits are occupied
+                    _heights[x] = y - r;
+            }
+        }
+    }
+
+    // BLANK UP TO THE TOP
+    for (int w = 0; w < numWords; ++w)
+    {
+        for (uint64_t open = _blankColumns[w]; open != 0; open &= open - 1)
+        {
+            _heights[w * 64 + TrailingZeros64(open)] = y + 1;
+        }
+    }
+}
+
+void LargestEmptyRectangles::AdvanceHeights(int y)
+{
+    // Branchless, a word of columns at a time: an occupied bit clears its height
+    const OccupancyGrid &grid = _grid;
+    const uint64_t *row = grid.Row(y);
+    int *heights = _heights.data();
+    for (int base = 0; base < _width; base += 64)
+    {
+        uint64_t word = row[base >> 6];
+        int numColumns = min(64, _width - base);
+        for (int i = 0; i < numColumns; ++i)
+        {
+            int blankMask = (int)((word >> i) & 1) - 1;
+            heights[base + i] = (heights[base + i] + 1) & blankMask;
+        }
+    }
+}
+
+void LargestEmptyRectangles::Carve(const rectangle &rect)
+{
+    _grid.SetRectangle(rect.corner1, rect.corner2, true);
+
+    // CHANGED HEIGHTS: the carved rows and the blank columns hanging below them
+    int lastChangedRow = rect.corner2.y;
+    for (int x = rect.corner1.x; x <= rect.corner2.x; ++x)
+    {
+        int y = rect.corner2.y + 1;
+        while (y < _height && !_grid.IsOccupied(x, y))
+        {
+            y++;
+        }
+        lastChangedRow = max(lastChangedRow, y - 1);
+    }
+
+    // RESCAN the rows whose best rectangle overlaps the carved one. The histogram is
+    // loaded at the first of them, then carried down.
+    bool heightsLoaded = false;
+    for (int y = rect.corner1.y; y <= lastChangedRow; ++y)
+    {
+        const rectangle &best = _rowBest[y];
+        bool overlaps = _rowBestArea[y] > 0 &&
+            best.corner1.x <= rect.corner2.x && rect.corner1.x <= best.corner2.x &&
+            best.corner1.y <= rect.corner2.y && rect.corner1.y <= best.corner2.y;
+
+        if (heightsLoaded)
+        {
+            AdvanceHeights(y);
+        }
+        else if (overlaps)
+        {
+            LoadHeights(y);
+            heightsLoaded = true;
+        }
+
+        if (overlaps)
+        {
+            ScanRow(y);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <queue>
+
+using namespace std;
+
+#include "AuxStructures.h"
+#include "OccupancyGrid.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// LARGEST EMPTY RECTANGLE CARVER
+// Hands out the largest empty rectangle left, marking it occupied.
+// - Every row keeps its best rectangle with the bottom on that row, from the
+//   histogram of blank cells above it (monotonic stack, O(W)).
+// - A single histogram row is kept, updated row by row as the rows are swept
+//   down: the grid itself is only 1 bit per cell.
+// - Carving only lowers the heights of its columns, down to the next occupied
+//   cell. Heights only go down, so a row's best rectangle is still the best one
+//   as long as it doesn't overlap a carved rectangle: only those rows are
+//   scanned again, sweeping down from the histogram above the first one.
+// - A max-heap of (area, row) with stale entries skipped gives the global best.
+////////////////////////////////////////////////////////////////////////////////
+class LargestEmptyRectangles {
+
+public:
+    explicit LargestEmptyRectangles(const OccupancyGrid &grid);
+
+    // False when there's no blank cell left
+    bool Next(rectangle &rect);
+
+private:
+    int _width;
+    int _height;
+    OccupancyGrid _grid;        // carved rectangles are occupied
+    vector<int> _heights;       // histogram of one row: blank cells up from (x, y), included
+    vector<uint64_t> _blankColumns;
+    vector<rectangle> _rowBest;
+    vector<int> _rowBestArea;
+    priority_queue<pair<int, int>> _candidates; // (area, -row): top rows win the ties
+    vector<int> _stack;
+
+    // _heights of row y, from scratch (columns scanned up a word at a time)
+    void LoadHeights(int y);
+    // _heights from row y - 1 to row y
+    void AdvanceHeights(int y);
+    void ScanRow(int y);
+    void Carve(const rectangle &rect);
+};
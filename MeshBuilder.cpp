@@ -0,0 +1,173 @@
+#include "MeshBuilder.h"
+
+#include <math.h>
+#include <algorithm>
+using namespace std;
+
+MeshBuilder::MeshBuilder() :
+    _polygonStarts(1, 0)
+{
+}
+
+void MeshBuilder::AddTileLattice(const vector<double> &xs, const vector<double> &ys)
+{
+    int numTilesX = (int)xs.size() - 1;
+    int numTilesY = (int)ys.size() - 1;
+    if (numTilesX <= 0 || numTilesY <= 0)
+        return;
+
+    // Vertex (i, j) of the lattice is first + (j * (numTilesX + 1)) + i
+    int first = _vertices.size();
+    int numVerticesX = numTilesX + 1;
+    _vertices.reserve(_vertices.size() + (numVerticesX * (numTilesY + 1)));
+    for (int j = 0; j <= numTilesY; ++j)
+    {
+        for (int i = 0; i <= numTilesX; ++i)
+        {
+            _vertices.push_back(meshVertex(xs[i], ys[j]));
+        }
+    }
+
+    // Tile vertices IN ANTICLOCKWISE ORDER
+    // 1 --- 4
+    // |     |
+    // |     |
+    // 2 --- 3
+    _indices.reserve(_indices.size() + (numTilesX * numTilesY * 4));
+    _polygonStarts.reserve(_polygonStarts.size() + (numTilesX * numTilesY));
+    for (int j = 0; j < numTilesY; ++j)
+    {
+        for (int i = 0; i < numTilesX; ++i)
+        {
+            int upperLeft = first + (j * numVerticesX) + i;
+            _indices.push_back(upperLeft);
+            _indices.push_back(upperLeft + numVerticesX);
+            _indices.push_back(upperLeft + numVerticesX + 1);
+            _indices.push_back(upperLeft + 1);
+            _polygonStarts.push_back(_indices.size());
+        }
+    }
+}
+
+vector<double> MeshBuilder::LatticeLines(double from, double to, double origin, double tileSize)
+{
+    // Lattice lines closer than this to a side are the side itself (no sliver tiles)
+    double tolerance = tileSize * 1e-6;
+
+    vector<double> lines;
+    lines.push_back(from);
+    if (from < to)
+    {
+        double line = origin + (floor((from - origin) / tileSize) + 1) * tileSize;
+        for (; line < to - tolerance; line += tileSize)
+        {
+            if (line > from + tolerance)
+                lines.push_back(line);
+        }
+    }
+    else
+    {
+        double line = origin + (ceil((from - origin) / tileSize) - 1) * tileSize;
+        for (; line > to + tolerance; line -= tileSize)
+        {
+            if (line < from - tolerance)
+                lines.push_back(line);
+        }
+    }
+    if (to != from)
+        lines.push_back(to);
+    return lines;
+}
+
+void MeshBuilder::AddRectangle(const meshVertex &upperLeft, const meshVertex &lowerRight,
+    const vector<meshVertex> &sideVertices, MeshMode mode)
+{
+    double minX = upperLeft.x;
+    double maxX = lowerRight.x;
+    double minY = lowerRight.y;
+    double maxY = upperLeft.y;
+
+    // SIDE VERTICES, each side in the order it is walked (anticlockwise, from the upper-left corner)
+    vector<meshVertex> left, bottom, right, top;
+    for (int i = 0; i < sideVertices.size(); ++i)
+    {
+        const meshVertex &vertex = sideVertices[i];
+        bool insideX = vertex.x > minX && vertex.x < maxX;
+        bool insideY = vertex.y > minY && vertex.y < maxY;
+        if (vertex.x == minX && insideY) left.push_back(vertex);
+        else if (vertex.y == minY && insideX) bottom.push_back(vertex);
+        else if (vertex.x == maxX && insideY) right.push_back(vertex);
+        else if (vertex.y == maxY && insideX) top.push_back(vertex);
+    }
+    sort(left.begin(), left.end(), [](const meshVertex &v1, const meshVertex &v2) { return v1.y > v2.y; });
+    sort(bottom.begin(), bottom.end(), [](const meshVertex &v1, const meshVertex &v2) { return v1.x < v2.x; });
+    sort(right.begin(), right.end(), [](const meshVertex &v1, const meshVertex &v2) { return v1.y < v2.y; });
+    sort(top.begin(), top.end(), [](const meshVertex &v1, const meshVertex &v2) { return v1.x > v2.x; });
+
+    // OUTLINE IN ANTICLOCKWISE ORDER
+    // 1 --- 4
+    // |     |
+    // |     |
+    // 2 --- 3
+    vector<int> outline;
+    outline.push_back(AddVertex(meshVertex(minX, maxY)));
+    for (int i = 0; i < left.size(); ++i) outline.push_back(AddVertex(left[i]));
+    outline.push_back(AddVertex(meshVertex(minX, minY)));
+    for (int i = 0; i < bottom.size(); ++i) outline.push_back(AddVertex(bottom[i]));
+    outline.push_back(AddVertex(meshVertex(maxX, minY)));
+    for (int i = 0; i < right.size(); ++i) outline.push_back(AddVertex(right[i]));
+    outline.push_back(AddVertex(meshVertex(maxX, maxY)));
+    for (int i = 0; i < top.size(); ++i) outline.push_back(AddVertex(top[i]));
+
+    // The same vertex can come more than once
+    outline.erase(unique(outline.begin(), outline.end()), outline.end());
+
+    if (mode != MeshMode::TRIANGLES)
+    {
+        AddPolygon(&outline[0], outline.size());
+    }
+    else if (outline.size() == 4)
+    {
+        int triangle1[3] = { outline[0], outline[1], outline[2] };
+        int triangle2[3] = { outline[0], outline[2], outline[3] };
+        AddPolygon(triangle1, 3);
+        AddPolygon(triangle2, 3);
+    }
+    else
+    {
+        // Side vertices are on the same line as their corners: a fan from a corner
+        // would give flat triangles, a fan from the center does not
+        int center = AddVertex(meshVertex((minX + maxX) / 2.0, (minY + maxY) / 2.0));
+        for (int i = 0; i < outline.size(); ++i)
+        {
+            int triangle[3] = { center, outline[i], outline[(i + 1) % outline.size()] };
+            AddPolygon(triangle, 3);
+        }
+    }
+}
+
+int MeshBuilder::AddVertex(const meshVertex &vertex)
+{
+    auto found = _vertexIndices.find(vertex);
+    if (found != _vertexIndices.end())
+        return found->second;
+
+    int index = _vertices.size();
+    _vertices.push_back(vertex);
+    _vertexIndices[vertex] = index;
+    return index;
+}
+
+void MeshBuilder::AddPolygon(const int *indices, int count)
+{
+    _indices.insert(_indices.end(), indices, indices + count);
+    _polygonStarts.push_back(_indices.size());
+}
+
+void MeshBuilder::Clear()
+{
+    _vertices.clear();
+    _indices.clear();
+    _polygonStarts.assign(1, 0);
+    _vertexIndices.clear();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+struct meshVertex
+{
+    double x;
+    double y;
+
+    meshVertex(double _x = 0, double _y = 0) :
+        x(_x), y(_y) {}
+
+    bool operator==(const meshVertex &other) const { return x == other.x && y == other.y; }
+};
+
+enum class MeshMode
+{
+    TILES,      // a square per cell
+    QUADS,      // a single polygon per rectangle
+    TRIANGLES   // 2 triangles per rectangle
+};
+
+struct meshVertexHash
+{
+    size_t operator()(const meshVertex &vertex) const
+    {
+        hash<double> hasher;
+        return hasher(vertex.x) * 31 + hasher(vertex.y);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// MESH BUILDER
+// Vertex and index buffers of a polygon mesh, built without searching for
+// vertices polygon by polygon:
+// - AddTileLattice: the vertices of a grid of tiles are numbered straight from
+//   their lattice position (i, j).
+// - AddVertex: any other vertex goes through a hash map, so the same position
+//   always gives the same index.
+// - AddRectangle: the minimal polygons of a rectangle (QUADS or TRIANGLES), with
+//   the extra vertices its neighbours need on its sides (T-junctions).
+// Polygons are given IN ANTICLOCKWISE ORDER and can have any number of vertices.
+// It knows nothing about AI.Implant: ACXUtilities copies the buffers into a BGT_Mesh.
+////////////////////////////////////////////////////////////////////////////////
+class MeshBuilder {
+
+public:
+    MeshBuilder();
+
+    // One tile between every two consecutive lines: xs left to right, ys top to bottom
+    // (y grows upwards). Vertices shared with other parts of the mesh are not merged.
+    void AddTileLattice(const vector<double> &xs, const vector<double> &ys);
+    // Lines of a tile lattice (origin + k * tileSize) from one side of an area to the
+    // other, both sides included, in that order. Sides off the lattice give partial
+    // tiles at the ends instead of tiles out of (or missing from) the area.
+    static vector<double> LatticeLines(double from, double to, double origin, double tileSize);
+
+    // QUADS: one polygon with the 4 corners and the side vertices.
+    // TRIANGLES: 2 triangles, or a fan around the center when there are side vertices.
+    // Side vertices not strictly inside a side are ignored.
+    void AddRectangle(const meshVertex &upperLeft, const meshVertex &lowerRight,
+        const vector<meshVertex> &sideVertices, MeshMode mode);
+
+    int AddVertex(const meshVertex &vertex);
+    void AddPolygon(const int *indices, int count);
+
+    int NumVertices() const { return (int)_vertices.size(); }
+    int NumPolygons() const { return (int)_polygonStarts.size() - 1; }
+    const meshVertex &Vertex(int index) const { return _vertices[index]; }
+    // Indices of the polygon: PolygonIndices(p)[0 .. PolygonSize(p) - 1]
+    const int *PolygonIndices(int polygon) const { return &_indices[_polygonStarts[polygon]]; }
+    int PolygonSize(int polygon) const { return _polygonStarts[polygon + 1] - _polygonStarts[polygon]; }
+
+    void Clear();
+
+private:
+    vector<meshVertex> _vertices;
+    vector<int> _indices;
+    vector<int> _polygonStarts; // first index of every polygon, and the end of the last one
+    unordered_map<meshVertex, int, meshVertexHash> _vertexIndices; // only the ones from AddVertex
+};
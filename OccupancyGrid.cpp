@@ -0,0 +1,253 @@
+#include "OccupancyGrid.h"
+
+#include "BitScan.h"
+
+OccupancyGrid::OccupancyGrid(int width, int height) :
+    _width(width), _height(height), _wordsPerRow((width + 63) / 64),
+    _words(_wordsPerRow * height, 0)
+{
+    // Padding bits are occupied
+    if ((width & 63) != 0)
+    {
+        uint64_t padding = ~WordMask(0, (width & 63) - 1);
+        for (int y = 0; y < height; ++y)
+        {
+            Row(y)[_wordsPerRow - 1] = padding;
+        }
+    }
+    RebuildSummaries();
+}
+
+OccupancyGrid::OccupancyGrid(const vector<vector<int>> &legacyGrid) :
+    OccupancyGrid(legacyGrid.empty() ? 0 : legacyGrid[0].size(), legacyGrid.size())
+{
+    for (int y = 0; y < _height; ++y)
+    {
+        for (int x = 0; x < _width; ++x)
+        {
+            if (legacyGrid[y][x] == 1)
+            {
+                Set(x, y, true);
+            }
+        }
+    }
+}
+
+void OccupancyGrid::Set(int x, int y, bool occupied)
+{
+    uint64_t bit = 1ULL << (x & 63);
+    if (occupied)
+        Row(y)[x >> 6] |= bit;
+    else
+        Row(y)[x >> 6] &= ~bit;
+    UpdateSummary(y * _wordsPerRow + (x >> 6));
+}
+
+void OccupancyGrid::SetRectangle(const coord2D &_rectInit, const coord2D &_rectEnd, bool occupied)
+{
+    // Whole words at a time: the first and last word of each row are masked
+    int firstWord = _rectInit.x >> 6;
+    int lastWord = _rectEnd.x >> 6;
+    for (int y = _rectInit.y; y <= _rectEnd.y; ++y)
+    {
+        uint64_t *row = Row(y);
+        for (int w = firstWord; w <= lastWord; ++w)
+        {
+            int first = (w == firstWord) ? (_rectInit.x & 63) : 0;
+            int last = (w == lastWord) ? (_rectEnd.x & 63) : 63;
+            uint64_t mask = WordMask(first, last);
+            if (occupied)
+                row[w] |= mask;
+            else
+                row[w] &= ~mask;
+            UpdateSummary(y * _wordsPerRow + w);
+        }
+    }
+}
+
+int OccupancyGrid::CountBlanks() const
+{
+    // Padding bits are occupied, so every zero bit is a blank cell.
+    // Only the words that aren't full are visited.
+    int numBlanks = 0;
+    for (int wordIdx = FindNonFullWord(0); wordIdx < _words.size(); wordIdx = FindNonFullWord(wordIdx + 1))
+    {
+        numBlanks += 64 - PopCount64(_words[wordIdx]);
+    }
+    return numBlanks;
+}
+
+bool OccupancyGrid::IsFull() const
+{
+    for (int t = 0; t < _fullBlocks.size(); ++t)
+    {
+        if (_fullBlocks[t] != ~0ULL)
+            return false;
+    }
+    return true;
+}
+
+bool OccupancyGrid::FindFirstBlank(const coord2D &_from, coord2D &_pos) const
+{
+    // Rows are contiguous, so the words can be walked as a single array.
+    // Padding bits are occupied: any zero bit found is a real cell.
+    int wordIdx = _from.y * _wordsPerRow + (_from.x >> 6);
+    uint64_t ignored = (1ULL << (_from.x & 63)) - 1; // cells before _from in its word
+    if (_from.x >= _width)
+    {
+        wordIdx = (_from.y + 1) * _wordsPerRow;
+        ignored = 0;
+    }
+    if (wordIdx >= _words.size())
+        return false;
+
+    uint64_t blanks = ~(_words[wordIdx] | ignored);
+    if (blanks == 0)
+    {
+        // SKIP the full words through the summaries
+        wordIdx = FindNonFullWord(wordIdx + 1);
+        if (wordIdx >= _words.size())
+            return false;
+        blanks = ~_words[wordIdx];
+    }
+    _pos = coord2D((wordIdx % _wordsPerRow) * 64 + TrailingZeros64(blanks), wordIdx / _wordsPerRow);
+    return true;
+}
+
+int OccupancyGrid::FindNextOccupiedInRow(int x, int y) const
+{
+    // The padding bits stop the search at the row end
+    int next = GetBitScanKernels().FindNextOccupied(Row(y), _wordsPerRow, x);
+    return (next < _width) ? next : _width;
+}
+
+bool OccupancyGrid::RowSpanIsFree(int y, int x0, int x1) const
+{
+    return GetBitScanKernels().SpanIsFree(Row(y), x0, x1);
+}
+
+OccupancyGrid OccupancyGrid::Crop(const coord2D &_rectInit, const coord2D &_rectEnd) const
+{
+    OccupancyGrid cropped(_rectEnd.x - _rectInit.x + 1, _rectEnd.y - _rectInit.y + 1);
+    int shift = _rectInit.x & 63;
+    int firstWord = _rectInit.x >> 6;
+    uint64_t padding = ((cropped._width & 63) == 0) ? 0 : ~WordMask(0, (cropped._width & 63) - 1);
+
+    for (int y = 0; y < cropped._height; ++y)
+    {
+        const uint64_t *source = Row(_rectInit.y + y);
+        uint64_t *target = cropped.Row(y);
+        for (int w = 0; w < cropped._wordsPerRow; ++w)
+        {
+            // 64 source bits starting at _rectInit.x + 64 * w, straddling two words
+            int sourceWord = firstWord + w;
+            uint64_t bits = source[sourceWord] >> shift;
+            if (shift != 0 && sourceWord + 1 < _wordsPerRow)
+            {
+                bits |= source[sourceWord + 1] << (64 - shift);
+            }
+            target[w] = bits;
+        }
+        target[cropped._wordsPerRow - 1] |= padding;
+    }
+    cropped.RebuildSummaries();
+    return cropped;
+}
+
+OccupancyGrid OccupancyGrid::Oriented(bool transpose, bool mirrorX, bool mirrorY) const
+{
+    OccupancyGrid oriented(transpose ? _height : _width, transpose ? _width : _height);
+    for (int y = 0; y < _height; ++y)
+    {
+        for (int x = 0; x < _width; ++x)
+        {
+            if (!IsOccupied(x, y))
+                continue;
+
+            int ox = transpose ? y : x;
+            int oy = transpose ? x : y;
+            if (mirrorX)
+                ox = oriented._width - 1 - ox;
+            if (mirrorY)
+                oy = oriented._height - 1 - oy;
+            oriented.Set(ox, oy, true);
+        }
+    }
+    return oriented;
+}
+
+vector<vector<int>> OccupancyGrid::ToVector() const
+{
+    vector<vector<int>> legacyGrid(_height, vector<int>(_width));
+    for (int y = 0; y < _height; ++y)
+    {
+        for (int x = 0; x < _width; ++x)
+        {
+            legacyGrid[y][x] = IsOccupied(x, y) ? 1 : 0;
+        }
+    }
+    return legacyGrid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SUMMARIES
+////////////////////////////////////////////////////////////////////////////////
+void OccupancyGrid::UpdateSummary(int wordIdx)
+{
+    int s = wordIdx >> 6;
+    uint64_t bit = 1ULL << (wordIdx & 63);
+    if (_words[wordIdx] == ~0ULL)
+        _fullWords[s] |= bit;
+    else
+        _fullWords[s] &= ~bit;
+
+    uint64_t blockBit = 1ULL << (s & 63);
+    if (_fullWords[s] == ~0ULL)
+        _fullBlocks[s >> 6] |= blockBit;
+    else
+        _fullBlocks[s >> 6] &= ~blockBit;
+}
+
+void OccupancyGrid::RebuildSummaries()
+{
+    // The bits past the end are full, so they never stop a search
+    int numSummaryWords = (_words.size() + 63) / 64;
+    _fullWords.assign(numSummaryWords, ~0ULL);
+    _fullBlocks.assign((numSummaryWords + 63) / 64, ~0ULL);
+    for (int wordIdx = 0; wordIdx < _words.size(); ++wordIdx)
+    {
+        if (_words[wordIdx] != ~0ULL)
+        {
+            _fullWords[wordIdx >> 6] &= ~(1ULL << (wordIdx & 63));
+            _fullBlocks[wordIdx >> 12] &= ~(1ULL << ((wordIdx >> 6) & 63));
+        }
+    }
+}
+
+int OccupancyGrid::FindNonFullWord(int wordIdx) const
+{
+    int numWords = _words.size();
+    while (wordIdx < numWords)
+    {
+        // Rest of the current summary word
+        int s = wordIdx >> 6;
+        uint64_t notFull = ~_fullWords[s] & (~0ULL << (wordIdx & 63));
+        if (notFull != 0)
+            return s * 64 + TrailingZeros64(notFull);
+
+        // Next summary word that isn't full, 64 of them per test
+        s++;
+        int t = s >> 6;
+        if (t >= _fullBlocks.size())
+            return numWords;
+        uint64_t notFullBlocks = ~_fullBlocks[t] & (~0ULL << (s & 63));
+        while (notFullBlocks == 0)
+        {
+            if (++t >= _fullBlocks.size())
+                return numWords;
+            notFullBlocks = ~_fullBlocks[t];
+        }
+        wordIdx = (t * 64 + TrailingZeros64(notFullBlocks)) * 64;
+    }
+    return numWords;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+#include "AuxStructures.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// OCCUPANCY GRID
+// Contiguous bit-packed grid: 1 bit per cell (1 = occupied, 0 = blank),
+// stored row by row in 64-bit words. Each row starts on its own word; the
+// padding bits after the last column are kept as occupied, so whole words can
+// be tested without masking the row end.
+// Two summary levels are kept on top of the words (1 bit = "all occupied"):
+// one bit per word, and one bit per 64 summary bits. Searches for blanks skip
+// 64 full words, or 4096, with a single test: in a nearly complete grid they
+// only pay for the blank pockets left.
+////////////////////////////////////////////////////////////////////////////////
+class OccupancyGrid {
+
+public:
+    OccupancyGrid(int width = 0, int height = 0);
+    // Adapter for the legacy vector<vector<int>> grids (1 = occupied)
+    explicit OccupancyGrid(const vector<vector<int>> &legacyGrid);
+
+    int Width() const { return _width; }
+    int Height() const { return _height; }
+    bool Empty() const { return _width == 0 || _height == 0; }
+    int WordsPerRow() const { return _wordsPerRow; }
+
+    const uint64_t *Row(int y) const { return &_words[y * _wordsPerRow]; }
+
+    bool IsOccupied(int x, int y) const
+    {
+        return ((Row(y)[x >> 6] >> (x & 63)) & 1) != 0;
+    }
+
+    void Set(int x, int y, bool occupied);
+    void SetRectangle(const coord2D &_rectInit, const coord2D &_rectEnd, bool occupied);
+    int CountBlanks() const;
+    bool IsFull() const;
+    // First blank at or after _from in row-major order, skipping full words
+    bool FindFirstBlank(const coord2D &_from, coord2D &_pos) const;
+    // Word-wise row scans (see BitScan.h). Returns Width() when there is no occupied cell.
+    int FindNextOccupiedInRow(int x, int y) const;
+    bool RowSpanIsFree(int y, int x0, int x1) const;
+
+    // Copy of the cells [_rectInit, _rectEnd], as a grid of their own
+    OccupancyGrid Crop(const coord2D &_rectInit, const coord2D &_rectEnd) const;
+    // Copy in another orientation: transposed first (x <-> y), then mirrored
+    OccupancyGrid Oriented(bool transpose, bool mirrorX, bool mirrorY) const;
+
+    vector<vector<int>> ToVector() const;
+
+private:
+    int _width;
+    int _height;
+    int _wordsPerRow;
+    vector<uint64_t> _words;
+    vector<uint64_t> _fullWords;  // bit per word of _words
+    vector<uint64_t> _fullBlocks; // bit per word of _fullWords
+
+    // Writes through here must be followed by UpdateSummary (or RebuildSummaries)
+    uint64_t *Row(int y) { return &_words[y * _wordsPerRow]; }
+    void UpdateSummary(int wordIdx);
+    void RebuildSummaries();
+    // First word at or after wordIdx with a blank (_words.size() if none)
+    int FindNonFullWord(int wordIdx) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// BLANK CURSOR
+// Row-major scan for blanks that resumes where the last one was found, so
+// finding every blank of a grid is linear overall.
+// It is only valid while cells are marked as occupied, never released.
+////////////////////////////////////////////////////////////////////////////////
+class BlankCursor {
+
+public:
+    BlankCursor(const OccupancyGrid &grid) :
+        _grid(&grid), _pos(0, 0) {}
+
+    bool Next(coord2D &_blank)
+    {
+        if (!_grid->FindFirstBlank(_pos, _pos))
+            return false;
+        _blank = _pos;
+        return true;
+    }
+
+private:
+    const OccupancyGrid *_grid;
+    coord2D _pos;
+};
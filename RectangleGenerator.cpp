@@ -0,0 +1,89 @@
+#include "RectangleGenerator.h"
+#include "LargestEmptyRectangle.h"
+
+using namespace std;
+
+// Rectangles the background producer can get ahead of the consumer
+static const int MAX_QUEUED_RECTANGLES = 4096;
+
+RectangleGenerator::RectangleGenerator(OccupancyGrid grid, TessellationMode mode, bool background) :
+    _grid(std::move(grid)), _mode(mode), _firstBlank(_grid), _nextInSolution(0), _solved(false),
+    _background(background), _producerFinished(false), _stop(false)
+{
+    if (_mode == TessellationMode::LARGEST_EMPTY)
+    {
+        _carver.reset(new LargestEmptyRectangles(_grid));
+    }
+    if (_background)
+    {
+        _producer = thread(&RectangleGenerator::ProducerLoop, this);
+    }
+}
+
+RectangleGenerator::~RectangleGenerator()
+{
+    if (_producer.joinable())
+    {
+        _stop = true;
+        {
+            lock_guard<mutex> guard(_queueLock);
+        }
+        _queueChanged.notify_all();
+        _producer.join();
+    }
+}
+
+bool RectangleGenerator::Next(rectangle &rect)
+{
+    if (!_background)
+        return Produce(rect);
+
+    unique_lock<mutex> guard(_queueLock);
+    _queueChanged.wait(guard, [this] { return !_queue.empty() || _producerFinished; });
+    if (_queue.empty())
+        return false;
+
+    rect = _queue.front();
+    _queue.pop_front();
+    _queueChanged.notify_all(); // room for the producer
+    return true;
+}
+
+bool RectangleGenerator::Produce(rectangle &rect)
+{
+    switch (_mode)
+    {
+    case TessellationMode::ITERATIVE:
+        return _tessellator.NextIterativeRectangle(_grid, _firstBlank, rect);
+
+    case TessellationMode::LARGEST_EMPTY:
+        return _carver->Next(rect);
+
+    default:
+        if (!_solved)
+        {
+            _tessellator.CalculateRectangles(std::move(_grid), _solution, _mode);
+            _solved = true;
+        }
+        if (_nextInSolution >= _solution.size())
+            return false;
+        rect = _solution[_nextInSolution++];
+        return true;
+    }
+}
+
+void RectangleGenerator::ProducerLoop()
+{
+    rectangle rect;
+    while (!_stop && Produce(rect))
+    {
+        unique_lock<mutex> guard(_queueLock);
+        _queueChanged.wait(guard, [this] { return _queue.size() < MAX_QUEUED_RECTANGLES || _stop; });
+        _queue.push_back(rect);
+        _queueChanged.notify_all();
+    }
+
+    lock_guard<mutex> guard(_queueLock);
+    _producerFinished = true;
+    _queueChanged.notify_all();
+}
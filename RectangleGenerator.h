@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <iterator>
+
+using namespace std;
+
+#include "AuxStructures.h"
+#include "OccupancyGrid.h"
+#include "Tessellator.h"
+
+class LargestEmptyRectangles;
+
+////////////////////////////////////////////////////////////////////////////////
+// RECTANGLE GENERATOR
+// Pull-based tessellation: every Next() hands out one more rectangle, so the
+// next stages can start with the first one instead of waiting for the whole
+// solution.
+// - ITERATIVE and LARGEST_EMPTY are stepped lazily: a rectangle is given out as
+//   soon as it is closed.
+// - The other modes solve the whole grid on the first call, then hand it out.
+// In background mode a producer thread runs ahead (up to a bounded queue) while
+// the caller consumes, so both stages overlap.
+////////////////////////////////////////////////////////////////////////////////
+class RectangleGenerator {
+
+public:
+    RectangleGenerator(OccupancyGrid grid, TessellationMode mode = TessellationMode::ITERATIVE,
+        bool background = false);
+    ~RectangleGenerator();
+
+    // False when the grid is complete
+    bool Next(rectangle &rect);
+
+    // Input iterator: for (const rectangle &rect : generator)
+    class iterator {
+
+    public:
+        typedef input_iterator_tag iterator_category;
+        typedef rectangle value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const rectangle *pointer;
+        typedef const rectangle &reference;
+
+        iterator(RectangleGenerator *generator = NULL) :
+            _generator(generator) { ++(*this); }
+
+        const rectangle &operator*() const { return _current; }
+        const rectangle *operator->() const { return &_current; }
+        iterator &operator++()
+        {
+            if (_generator != NULL && !_generator->Next(_current))
+                _generator = NULL;
+            return *this;
+        }
+        bool operator==(const iterator &other) const { return _generator == other._generator; }
+        bool operator!=(const iterator &other) const { return _generator != other._generator; }
+
+    private:
+        RectangleGenerator *_generator;
+        rectangle _current;
+    };
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    OccupancyGrid _grid;
+    TessellationMode _mode;
+    BlankCursor _firstBlank; // ITERATIVE: everything before it is occupied yet
+    Tessellator _tessellator;
+    unique_ptr<LargestEmptyRectangles> _carver;
+    vector<rectangle> _solution; // modes solved at once
+    int _nextInSolution;
+    bool _solved;
+
+    // Background producer
+    bool _background;
+    thread _producer;
+    mutex _queueLock;
+    condition_variable _queueChanged;
+    deque<rectangle> _queue;
+    bool _producerFinished;
+    atomic<bool> _stop;
+
+    RectangleGenerator(const RectangleGenerator &);
+    RectangleGenerator &operator=(const RectangleGenerator &);
+
+    bool Produce(rectangle &rect);
+    void ProducerLoop();
+};
@@ -0,0 +1,289 @@
+#include "RectangleOptimizer.h"
+
+#include <algorithm>
+using namespace std;
+
+// Neighbours of a rectangle tried in pairs for the 3 into 2 moves
+static const int MAX_RECUT_NEIGHBOURS = 8;
+
+static long long RectangleArea(const rectangle &rect)
+{
+    return (long long)(rect.corner2.x - rect.corner1.x + 1) * (rect.corner2.y - rect.corner1.y + 1);
+}
+
+static bool RectanglesIntersect(const rectangle &a, const rectangle &b)
+{
+    return a.corner1.x <= b.corner2.x && b.corner1.x <= a.corner2.x &&
+           a.corner1.y <= b.corner2.y && b.corner1.y <= a.corner2.y;
+}
+
+RectangleOptimizer::RectangleOptimizer(const vector<rectangle> &rects) :
+    _numAlive(0)
+{
+    for (int i = 0; i < rects.size(); ++i)
+    {
+        Add(rects[i]);
+    }
+}
+
+long long RectangleOptimizer::Run(long long maxMoves)
+{
+    for (int id = 0; id < _rects.size(); ++id)
+    {
+        if (_alive[id])
+            Queue(id);
+    }
+
+    long long numMoves = 0;
+    vector<int> neighbours;
+    while (!_workList.empty() && (maxMoves < 0 || numMoves < maxMoves))
+    {
+        int id = _workList.front();
+        _workList.pop_front();
+        _queued[id] = false;
+        if (!_alive[id])
+            continue;
+
+        neighbours.clear();
+        Neighbours(id, neighbours);
+        if (TryMerge(id, neighbours) || TryRecut(id, neighbours))
+        {
+            numMoves++;
+        }
+    }
+    return numMoves;
+}
+
+void RectangleOptimizer::GetRectangles(vector<rectangle> &rects) const
+{
+    for (int id = 0; id < _rects.size(); ++id)
+    {
+        if (_alive[id])
+            rects.push_back(_rects[id]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ADJACENCY INDEX
+////////////////////////////////////////////////////////////////////////////////
+int RectangleOptimizer::Add(const rectangle &rect)
+{
+    int id = _rects.size();
+    _rects.push_back(rect);
+    _alive.push_back(true);
+    _queued.push_back(false);
+    _numAlive++;
+
+    _byLeft[make_pair(rect.corner1.x, rect.corner1.y)] = id;
+    _byRight[make_pair(rect.corner2.x, rect.corner1.y)] = id;
+    _byTop[make_pair(rect.corner1.y, rect.corner1.x)] = id;
+    _byBottom[make_pair(rect.corner2.y, rect.corner1.x)] = id;
+    return id;
+}
+
+void RectangleOptimizer::Remove(int id)
+{
+    const rectangle &rect = _rects[id];
+    _byLeft.erase(make_pair(rect.corner1.x, rect.corner1.y));
+    _byRight.erase(make_pair(rect.corner2.x, rect.corner1.y));
+    _byTop.erase(make_pair(rect.corner1.y, rect.corner1.x));
+    _byBottom.erase(make_pair(rect.corner2.y, rect.corner1.x));
+    _alive[id] = false;
+    _numAlive--;
+}
+
+void RectangleOptimizer::Queue(int id)
+{
+    if (!_queued[id])
+    {
+        _queued[id] = true;
+        _workList.push_back(id);
+    }
+}
+
+void RectangleOptimizer::Neighbours(int id, vector<int> &neighbours) const
+{
+    const rectangle &rect = _rects[id];
+    SideNeighbours(_byLeft, rect.corner2.x + 1, rect.corner1.y, rect.corner2.y, true, neighbours);   // right
+    SideNeighbours(_byRight, rect.corner1.x - 1, rect.corner1.y, rect.corner2.y, true, neighbours);  // left
+    SideNeighbours(_byTop, rect.corner2.y + 1, rect.corner1.x, rect.corner2.x, false, neighbours);   // below
+    SideNeighbours(_byBottom, rect.corner1.y - 1, rect.corner1.x, rect.corner2.x, false, neighbours); // above
+}
+
+void RectangleOptimizer::SideNeighbours(const SideIndex &index, int line, int from, int to, bool vertical,
+    vector<int> &neighbours) const
+{
+    // The rectangles on one line don't overlap along it: only the last one starting
+    // before 'from' can reach into the range
+    SideIndex::const_iterator it = index.upper_bound(make_pair(line, from));
+    if (it != index.begin())
+    {
+        SideIndex::const_iterator previous = it;
+        --previous;
+        if (previous->first.first == line)
+        {
+            const rectangle &rect = _rects[previous->second];
+            int end = vertical ? rect.corner2.y : rect.corner2.x;
+            if (end >= from)
+                neighbours.push_back(previous->second);
+        }
+    }
+    for (; it != index.end() && it->first.first == line && it->first.second <= to; ++it)
+    {
+        neighbours.push_back(it->second);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MOVES
+////////////////////////////////////////////////////////////////////////////////
+bool RectangleOptimizer::TryMerge(int id, const vector<int> &neighbours)
+{
+    const rectangle &rect = _rects[id];
+    for (int i = 0; i < neighbours.size(); ++i)
+    {
+        const rectangle &other = _rects[neighbours[i]];
+        bool sameRows = other.corner1.y == rect.corner1.y && other.corner2.y == rect.corner2.y;
+        bool sameColumns = other.corner1.x == rect.corner1.x && other.corner2.x == rect.corner2.x;
+        if (sameRows || sameColumns)
+        {
+            // Neighbours with the same rows are side by side, with the same columns one above the other
+            rectangle merged(coord2D(min(rect.corner1.x, other.corner1.x), min(rect.corner1.y, other.corner1.y)),
+                coord2D(max(rect.corner2.x, other.corner2.x), max(rect.corner2.y, other.corner2.y)));
+            vector<int> oldIds;
+            oldIds.push_back(id);
+            oldIds.push_back(neighbours[i]);
+            Replace(oldIds, vector<rectangle>(1, merged));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RectangleOptimizer::TryRecut(int id, const vector<int> &neighbours)
+{
+    int numNeighbours = min((int)neighbours.size(), MAX_RECUT_NEIGHBOURS);
+    vector<rectangle> recut;
+    for (int i = 0; i < numNeighbours; ++i)
+    {
+        for (int j = i + 1; j < numNeighbours; ++j)
+        {
+            const rectangle *triple[3] = { &_rects[id], &_rects[neighbours[i]], &_rects[neighbours[j]] };
+            recut.clear();
+            if (RecutTriple(triple, recut))
+            {
+                vector<int> oldIds;
+                oldIds.push_back(id);
+                oldIds.push_back(neighbours[i]);
+                oldIds.push_back(neighbours[j]);
+                Replace(oldIds, recut);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool RectangleOptimizer::RecutTriple(const rectangle *triple[3], vector<rectangle> &recut) const
+{
+    // The 3 rectangles don't overlap: they cover exactly the bounding box minus M
+    // when their areas add up to that and none of them gets into M
+    rectangle box = *triple[0];
+    long long area = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        box.corner1.x = min(box.corner1.x, triple[i]->corner1.x);
+        box.corner1.y = min(box.corner1.y, triple[i]->corner1.y);
+        box.corner2.x = max(box.corner2.x, triple[i]->corner2.x);
+        box.corner2.y = max(box.corner2.y, triple[i]->corner2.y);
+        area += RectangleArea(*triple[i]);
+    }
+    long long boxArea = RectangleArea(box);
+
+    // 3 INTO 1
+    if (area == boxArea)
+    {
+        recut.push_back(box);
+        return true;
+    }
+
+    // 3 INTO 2: an L shape, the box minus a rectangle M at one of its corners.
+    // The concave vertex of the L is on the lines of the sides of the 3 rectangles.
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            int cxs[2] = { triple[i]->corner1.x, triple[i]->corner2.x + 1 };
+            int cys[2] = { triple[j]->corner1.y, triple[j]->corner2.y + 1 };
+            for (int a = 0; a < 2; ++a)
+            {
+                for (int b = 0; b < 2; ++b)
+                {
+                    int cx = cxs[a];
+                    int cy = cys[b];
+                    if (cx <= box.corner1.x || cx > box.corner2.x || cy <= box.corner1.y || cy > box.corner2.y)
+                        continue;
+
+                    for (int corner = 0; corner < 4; ++corner)
+                    {
+                        bool right = (corner & 1) != 0;
+                        bool bottom = (corner & 2) != 0;
+                        rectangle missing(
+                            coord2D(right ? cx : box.corner1.x, bottom ? cy : box.corner1.y),
+                            coord2D(right ? box.corner2.x : cx - 1, bottom ? box.corner2.y : cy - 1));
+                        if (area != boxArea - RectangleArea(missing))
+                            continue;
+                        if (RectanglesIntersect(missing, *triple[0]) || RectanglesIntersect(missing, *triple[1]) ||
+                            RectanglesIntersect(missing, *triple[2]))
+                            continue;
+
+                        // Cut along the shorter side of M's notch
+                        int horizontalCut = (box.corner2.x - box.corner1.x) - (missing.corner2.x - missing.corner1.x);
+                        int verticalCut = (box.corner2.y - box.corner1.y) - (missing.corner2.y - missing.corner1.y);
+                        if (horizontalCut <= verticalCut)
+                        {
+                            // Full-width band on the other rows, then the piece beside M
+                            recut.push_back(rectangle(coord2D(box.corner1.x, bottom ? box.corner1.y : cy),
+                                coord2D(box.corner2.x, bottom ? cy - 1 : box.corner2.y)));
+                            recut.push_back(rectangle(coord2D(right ? box.corner1.x : cx, missing.corner1.y),
+                                coord2D(right ? cx - 1 : box.corner2.x, missing.corner2.y)));
+                        }
+                        else
+                        {
+                            // Full-height band on the other columns, then the piece above or below M
+                            recut.push_back(rectangle(coord2D(right ? box.corner1.x : cx, box.corner1.y),
+                                coord2D(right ? cx - 1 : box.corner2.x, box.corner2.y)));
+                            recut.push_back(rectangle(coord2D(missing.corner1.x, bottom ? box.corner1.y : cy),
+                                coord2D(missing.corner2.x, bottom ? cy - 1 : box.corner2.y)));
+                        }
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void RectangleOptimizer::Replace(const vector<int> &oldIds, const vector<rectangle> &newRects)
+{
+    // Everything around the changed area gets another chance
+    vector<int> around;
+    for (int i = 0; i < oldIds.size(); ++i)
+    {
+        Neighbours(oldIds[i], around);
+    }
+    for (int i = 0; i < oldIds.size(); ++i)
+    {
+        Remove(oldIds[i]);
+    }
+    for (int i = 0; i < newRects.size(); ++i)
+    {
+        Queue(Add(newRects[i]));
+    }
+    for (int i = 0; i < around.size(); ++i)
+    {
+        if (_alive[around[i]])
+            Queue(around[i]);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <deque>
+
+using namespace std;
+
+#include "AuxStructures.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// RECTANGLE OPTIMIZER (local search after any solver)
+// Moves, around every rectangle of a partition:
+// - 2 into 1: a neighbour with the same side is merged.
+// - 3 into 2 (or 1): the rectangle and two of its neighbours cover an L shape
+//   (or a rectangle), which is cut again with a single cut.
+// Neighbours come from an adjacency index: the rectangles sorted by the line of
+// each of their sides, so the ones across a side are a range lookup.
+// Every rectangle changed by a move puts its neighbours back in the work list;
+// it runs until no move applies or the move budget is spent.
+////////////////////////////////////////////////////////////////////////////////
+class RectangleOptimizer {
+
+public:
+    explicit RectangleOptimizer(const vector<rectangle> &rects);
+
+    // maxMoves < 0: no budget. Returns the number of moves done.
+    long long Run(long long maxMoves = -1);
+
+    int NumRectangles() const { return _numAlive; }
+    void GetRectangles(vector<rectangle> &rects) const;
+
+private:
+    typedef map<pair<int, int>, int> SideIndex; // (line, start) -> rectangle
+
+    vector<rectangle> _rects;
+    vector<bool> _alive;
+    int _numAlive;
+    SideIndex _byLeft;   // (x0, y0)
+    SideIndex _byRight;  // (x1, y0)
+    SideIndex _byTop;    // (y0, x0)
+    SideIndex _byBottom; // (y1, x0)
+    deque<int> _workList;
+    vector<bool> _queued;
+
+    int Add(const rectangle &rect);
+    void Remove(int id);
+    void Queue(int id);
+    void Neighbours(int id, vector<int> &neighbours) const;
+    void SideNeighbours(const SideIndex &index, int line, int from, int to, bool vertical,
+        vector<int> &neighbours) const;
+
+    bool TryMerge(int id, const vector<int> &neighbours);
+    bool TryRecut(int id, const vector<int> &neighbours);
+    bool RecutTriple(const rectangle *triple[3], vector<rectangle> &recut) const;
+    void Replace(const vector<int> &oldIds, const vector<rectangle> &newRects);
+};
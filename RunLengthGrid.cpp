@@ -0,0 +1,142 @@
+#include "RunLengthGrid.h"
+
+#include <algorithm>
+using namespace std;
+
+RunLengthGrid::RunLengthGrid(int width, int height) :
+    _width(width), _height(height), _rows(height)
+{
+}
+
+RunLengthGrid::RunLengthGrid(const OccupancyGrid &grid) :
+    _width(grid.Width()), _height(grid.Height()), _rows(grid.Height())
+{
+    for (int y = 0; y < _height; ++y)
+    {
+        // Blank from x to the next occupied cell, then skip the occupied ones
+        int x = 0;
+        while (x < _width)
+        {
+            if (grid.IsOccupied(x, y))
+            {
+                x++;
+                continue;
+            }
+            int end = grid.FindNextOccupiedInRow(x, y);
+            AddRun(y, x, end - 1);
+            x = end;
+        }
+    }
+}
+
+int RunLengthGrid::NumRuns() const
+{
+    int numRuns = 0;
+    for (int y = 0; y < _height; ++y)
+    {
+        numRuns += _rows[y].size();
+    }
+    return numRuns;
+}
+
+void RunLengthGrid::AddRun(int y, int x0, int x1)
+{
+    _rows[y].push_back(blankRun(y, x0, x1));
+}
+
+bool RunLengthGrid::FindFirstBlank(const coord2D &_from, coord2D &_pos) const
+{
+    if (_from.y >= _height)
+        return false;
+
+    int index = FindRun(_from.y, _from.x);
+    if (index < _rows[_from.y].size())
+    {
+        _pos = coord2D(max(_rows[_from.y][index].x0, _from.x), _from.y);
+        return true;
+    }
+
+    for (int y = _from.y + 1; y < _height; ++y)
+    {
+        if (!_rows[y].empty())
+        {
+            _pos = coord2D(_rows[y][0].x0, y);
+            return true;
+        }
+    }
+    return false;
+}
+
+int RunLengthGrid::RunEnd(int x, int y) const
+{
+    int index = FindRun(y, x);
+    if (index < _rows[y].size() && _rows[y][index].x0 <= x)
+        return _rows[y][index].x1;
+    return -1;
+}
+
+bool RunLengthGrid::SpanIsBlank(int y, int x0, int x1) const
+{
+    // Only one run can hold x0: it has to reach x1 too
+    int index = FindRun(y, x0);
+    return index < _rows[y].size() && _rows[y][index].x0 <= x0 && _rows[y][index].x1 >= x1;
+}
+
+void RunLengthGrid::MarkOccupied(const coord2D &_rectInit, const coord2D &_rectEnd)
+{
+    for (int y = _rectInit.y; y <= _rectEnd.y; ++y)
+    {
+        vector<blankRun> &row = _rows[y];
+        int first = FindRun(y, _rectInit.x);
+        int last = first;
+        while (last < row.size() && row[last].x0 <= _rectEnd.x)
+        {
+            last++;
+        }
+        if (first == last)
+            continue; // nothing blank under the rectangle
+
+        // What is left of the first and the last runs crossed
+        vector<blankRun> remains;
+        if (row[first].x0 < _rectInit.x)
+            remains.push_back(blankRun(y, row[first].x0, _rectInit.x - 1));
+        if (row[last - 1].x1 > _rectEnd.x)
+            remains.push_back(blankRun(y, _rectEnd.x + 1, row[last - 1].x1));
+
+        row.erase(row.begin() + first, row.begin() + last);
+        row.insert(row.begin() + first, remains.begin(), remains.end());
+    }
+}
+
+OccupancyGrid RunLengthGrid::ToOccupancyGrid() const
+{
+    OccupancyGrid grid(_width, _height);
+    if (grid.Empty())
+        return grid;
+
+    grid.SetRectangle(coord2D(0, 0), coord2D(_width - 1, _height - 1), true);
+    for (int y = 0; y < _height; ++y)
+    {
+        for (int r = 0; r < _rows[y].size(); ++r)
+        {
+            grid.SetRectangle(coord2D(_rows[y][r].x0, y), coord2D(_rows[y][r].x1, y), false);
+        }
+    }
+    return grid;
+}
+
+int RunLengthGrid::FindRun(int y, int x) const
+{
+    const vector<blankRun> &row = _rows[y];
+    int low = 0;
+    int high = row.size();
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (row[middle].x1 < x)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+#include "AuxStructures.h"
+#include "OccupancyGrid.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// RUN-LENGTH GRID
+// Every row is the sorted list of its blank runs; whatever is not in a run is
+// occupied. Memory and the operations below depend on the number of runs, not
+// on the number of cells.
+////////////////////////////////////////////////////////////////////////////////
+class RunLengthGrid {
+
+public:
+    // All occupied: blanks are added with AddRun
+    RunLengthGrid(int width = 0, int height = 0);
+    explicit RunLengthGrid(const OccupancyGrid &grid);
+
+    int Width() const { return _width; }
+    int Height() const { return _height; }
+    bool Empty() const { return _width == 0 || _height == 0; }
+    int NumRuns() const;
+    const vector<blankRun> &Row(int y) const { return _rows[y]; }
+
+    // Runs must be added left to right, not touching the previous one
+    void AddRun(int y, int x0, int x1);
+
+    // First blank at or after _from in row-major order
+    bool FindFirstBlank(const coord2D &_from, coord2D &_pos) const;
+    // Last cell of the run holding (x, y); -1 when the cell is occupied
+    int RunEnd(int x, int y) const;
+    bool SpanIsBlank(int y, int x0, int x1) const;
+    // Splits the runs crossed by the rectangle
+    void MarkOccupied(const coord2D &_rectInit, const coord2D &_rectEnd);
+
+    OccupancyGrid ToOccupancyGrid() const;
+
+private:
+    int _width;
+    int _height;
+    vector<vector<blankRun>> _rows;
+
+    // Index of the first run of the row ending at or after x
+    int FindRun(int y, int x) const;
+};
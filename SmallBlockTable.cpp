@@ -0,0 +1,179 @@
+#include "SmallBlockTable.h"
+
+static const int NUM_MASKS = 1 << (SMALL_BLOCK_SIZE * SMALL_BLOCK_SIZE);
+static const int FULL_MASK = NUM_MASKS - 1;
+
+// Entry: high nibble = number of rectangles, low nibble = first rectangle
+// ((width - 1) * 4 + height - 1, with its upper-left corner on the first blank)
+struct SmallBlockTable
+{
+    unsigned char entries[NUM_MASKS];
+};
+
+constexpr int SmallBlockCount(const SmallBlockTable &table, int mask)
+{
+    return table.entries[mask] >> 4;
+}
+
+constexpr int FirstBlankBit(int mask)
+{
+    int bit = 0;
+    while ((mask >> bit) & 1)
+    {
+        bit++;
+    }
+    return bit;
+}
+
+constexpr int RowBits(int x, int width)
+{
+    return ((1 << width) - 1) << x;
+}
+
+// Cells of the block covered by a rectangle
+constexpr int RectangleMask(int x, int y, int width, int height)
+{
+    int mask = 0;
+    for (int r = 0; r < height; ++r)
+    {
+        mask |= RowBits(x, width) << ((y + r) * SMALL_BLOCK_SIZE);
+    }
+    return mask;
+}
+
+// The table is built in chunks of masks, each one a constant evaluation of its own,
+// so none gets near the compilers' step limits (sanitizer builds count more steps)
+static const int NUM_TABLE_CHUNKS = 16;
+static const int TABLE_CHUNK_SIZE = NUM_MASKS / NUM_TABLE_CHUNKS;
+
+// Solves the masks of a chunk. The fuller ones (higher chunks) are solved yet.
+constexpr SmallBlockTable SolveTableChunk(SmallBlockTable table, int chunk)
+{
+    int firstMask = chunk * TABLE_CHUNK_SIZE;
+    int lastMask = (chunk + 1) * TABLE_CHUNK_SIZE - 1;
+    if (lastMask == FULL_MASK)
+    {
+        lastMask--; // the full block needs no rectangle: entry 0
+    }
+
+    // Marking a rectangle only sets bits: masks are solved from the fullest down
+    for (int mask = lastMask; mask >= firstMask; --mask)
+    {
+        // The first blank is the upper-left corner of its rectangle
+        int anchor = FirstBlankBit(mask);
+        int ax = anchor % SMALL_BLOCK_SIZE;
+        int ay = anchor / SMALL_BLOCK_SIZE;
+
+        int bestCount = 0xF;
+        int bestShape = 0;
+        for (int w = 1; ax + w <= SMALL_BLOCK_SIZE; ++w)
+        {
+            if ((mask >> (ay * SMALL_BLOCK_SIZE)) & RowBits(ax, w))
+                break;
+
+            int rect = 0;
+            for (int h = 1; ay + h <= SMALL_BLOCK_SIZE; ++h)
+            {
+                int row = RowBits(ax, w);
+                if ((mask >> ((ay + h - 1) * SMALL_BLOCK_SIZE)) & row)
+                    break;
+                rect |= row << ((ay + h - 1) * SMALL_BLOCK_SIZE);
+
+                int count = 1 + SmallBlockCount(table, mask | rect);
+                if (count < bestCount)
+                {
+                    bestCount = count;
+                    bestShape = (w - 1) * SMALL_BLOCK_SIZE + (h - 1);
+                }
+            }
+        }
+        table.entries[mask] = (unsigned char)((bestCount << 4) | bestShape);
+    }
+    return table;
+}
+
+// Chunk c on top of the chunks above it
+template <int CHUNK>
+struct SmallBlockTableChunk
+{
+    static constexpr SmallBlockTable table = SolveTableChunk(SmallBlockTableChunk<CHUNK + 1>::table, CHUNK);
+};
+
+template <>
+struct SmallBlockTableChunk<NUM_TABLE_CHUNKS>
+{
+    static constexpr SmallBlockTable table = {};
+};
+
+template <int CHUNK>
+constexpr SmallBlockTable SmallBlockTableChunk<CHUNK>::table;
+constexpr SmallBlockTable SmallBlockTableChunk<NUM_TABLE_CHUNKS>::table;
+
+static constexpr SmallBlockTable smallBlockTable = SmallBlockTableChunk<0>::table;
+
+////////////////////////////////////////////////////////////////////////////////
+// COMPILE-TIME CHECKS
+////////////////////////////////////////////////////////////////////////////////
+// Every entry of a chunk: its first rectangle is blank, and the rest is the entry it leads to
+constexpr bool TableIsConsistent(const SmallBlockTable &table, int chunk)
+{
+    for (int mask = chunk * TABLE_CHUNK_SIZE; mask < (chunk + 1) * TABLE_CHUNK_SIZE && mask < FULL_MASK; ++mask)
+    {
+        int anchor = FirstBlankBit(mask);
+        int shape = table.entries[mask] & 0xF;
+        int w = shape / SMALL_BLOCK_SIZE + 1;
+        int h = shape % SMALL_BLOCK_SIZE + 1;
+        int ax = anchor % SMALL_BLOCK_SIZE;
+        int ay = anchor / SMALL_BLOCK_SIZE;
+        if (ax + w > SMALL_BLOCK_SIZE || ay + h > SMALL_BLOCK_SIZE)
+            return false;
+
+        int rect = RectangleMask(ax, ay, w, h);
+        if ((mask & rect) != 0)
+            return false;
+        if (SmallBlockCount(table, mask) != 1 + SmallBlockCount(table, mask | rect))
+            return false;
+    }
+    return true;
+}
+
+// One chunk per check, like the build: each static_assert is its own evaluation
+template <int CHUNK>
+struct SmallBlockTableCheck
+{
+    static_assert(TableIsConsistent(smallBlockTable, CHUNK), "small block table: inconsistent entry");
+    static const bool checked = SmallBlockTableCheck<CHUNK + 1>::checked;
+};
+
+template <>
+struct SmallBlockTableCheck<NUM_TABLE_CHUNKS>
+{
+    static const bool checked = true;
+};
+
+static_assert(SmallBlockTableCheck<0>::checked, "small block table: unchecked chunks");
+static_assert(SmallBlockCount(smallBlockTable, FULL_MASK) == 0, "full block needs no rectangle");
+static_assert(SmallBlockCount(smallBlockTable, 0) == 1, "blank block is a single rectangle");
+static_assert(SmallBlockCount(smallBlockTable, 0xA5A5) == 8, "checkerboard: one rectangle per blank");
+static_assert(SmallBlockCount(smallBlockTable, 0x0660) == 4, "ring around a 2x2 hole: 4 rectangles");
+static_assert(SmallBlockCount(smallBlockTable, 0xCC00) == 2, "L shape: 2 rectangles");
+static_assert(SmallBlockCount(smallBlockTable, 0x6996) == 5, "4 single corners and the 2x2 center");
+
+int SmallBlockPartition(uint16_t occupiedMask, vector<rectangle> &solution)
+{
+    int mask = occupiedMask;
+    int count = SmallBlockCount(smallBlockTable, mask);
+    while (mask != FULL_MASK)
+    {
+        int anchor = FirstBlankBit(mask);
+        int shape = smallBlockTable.entries[mask] & 0xF;
+        int x = anchor % SMALL_BLOCK_SIZE;
+        int y = anchor / SMALL_BLOCK_SIZE;
+        int w = shape / SMALL_BLOCK_SIZE + 1;
+        int h = shape % SMALL_BLOCK_SIZE + 1;
+
+        solution.push_back(rectangle(coord2D(x, y), coord2D(x + w - 1, y + h - 1)));
+        mask |= RectangleMask(x, y, w, h);
+    }
+    return count;
+}
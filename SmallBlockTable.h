@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+#include "AuxStructures.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// SMALL BLOCK TABLE
+// Optimal partition of every 4x4 block, computed at compile time (constexpr)
+// into a 64 KB table: one entry per occupancy mask (bit y * 4 + x set = cell
+// occupied) with the number of rectangles and the first one of them.
+// The table is checked with static_asserts where it is built.
+// It is built (and checked) in 16 chunks, each a constant evaluation of its own:
+// with GCC a chunk takes about 3M of the 33M operations allowed by default, also
+// in sanitizer builds (-fsanitize=undefined). Clang and MSVC count steps in their
+// own units: if one still hits the limit, raise -fconstexpr-steps or /constexpr:steps.
+////////////////////////////////////////////////////////////////////////////////
+const int SMALL_BLOCK_SIZE = 4;
+
+// Appends the rectangles (block coordinates) and returns how many they are
+int SmallBlockPartition(uint16_t occupiedMask, vector<rectangle> &solution);
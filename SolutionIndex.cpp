@@ -0,0 +1,71 @@
+#include "SolutionIndex.h"
+
+using namespace std;
+
+SolutionIndex::SolutionIndex(int width, int height, const vector<rectangle> &solution) :
+    _width(width), _height(height), _labels(width * height, -1)
+{
+    _positions.reserve(solution.size());
+    _ids.reserve(solution.size());
+    for (int i = 0; i < solution.size(); ++i)
+    {
+        _positions.push_back(i);
+        _ids.push_back(i);
+        Label(solution[i], i);
+    }
+}
+
+int SolutionIndex::RectangleAt(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+        return -1;
+    return _labels[(y * _width) + x];
+}
+
+void SolutionIndex::Add(vector<rectangle> &solution, const rectangle &rect)
+{
+    int id;
+    if (_freeIds.empty())
+    {
+        id = _positions.size();
+        _positions.push_back(0);
+    }
+    else
+    {
+        id = _freeIds.back();
+        _freeIds.pop_back();
+    }
+
+    _positions[id] = solution.size();
+    _ids.push_back(id);
+    solution.push_back(rect);
+    Label(rect, id);
+}
+
+void SolutionIndex::Remove(vector<rectangle> &solution, int id)
+{
+    int position = _positions[id];
+    Label(solution[position], -1);
+
+    // The last rectangle takes its place
+    int last = solution.size() - 1;
+    solution[position] = solution[last];
+    _ids[position] = _ids[last];
+    _positions[_ids[position]] = position;
+
+    solution.pop_back();
+    _ids.pop_back();
+    _freeIds.push_back(id);
+}
+
+void SolutionIndex::Label(const rectangle &rect, int id)
+{
+    for (int y = rect.corner1.y; y <= rect.corner2.y; ++y)
+    {
+        int *row = &_labels[y * _width];
+        for (int x = rect.corner1.x; x <= rect.corner2.x; ++x)
+        {
+            row[x] = id;
+        }
+    }
+}
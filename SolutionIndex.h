@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+#include "AuxStructures.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// SOLUTION INDEX
+// Label map of a solution: the rectangle over every cell, so the ones around a
+// cell are found without going through the whole solution. Rectangles get an id
+// that doesn't change while they are in the solution; their position in the
+// solution vector does (removing one moves the last into its place).
+// It stays in sync as long as the solution is only changed through it
+// (Tessellator::RetessellateChanges does).
+////////////////////////////////////////////////////////////////////////////////
+class SolutionIndex {
+
+public:
+    SolutionIndex(int width, int height, const vector<rectangle> &solution);
+
+    // Id of the rectangle over the cell, -1 if none (or out of the grid)
+    int RectangleAt(int x, int y) const;
+    const rectangle &Rectangle(const vector<rectangle> &solution, int id) const { return solution[_positions[id]]; }
+
+    void Add(vector<rectangle> &solution, const rectangle &rect);
+    void Remove(vector<rectangle> &solution, int id);
+
+private:
+    int _width, _height;
+    vector<int> _labels;    // cell (row-major) -> id
+    vector<int> _positions; // id -> position in the solution
+    vector<int> _ids;       // position in the solution -> id
+    vector<int> _freeIds;
+
+    void Label(const rectangle &rect, int id);
+};
@@ -1,24 +1,99 @@
 #include "Tessellator.h"
 
+#include "HopcroftKarp.h"
+#include "BranchAndBound.h"
+#include "LargestEmptyRectangle.h"
+#include "RectangleOptimizer.h"
+#include "SmallBlockTable.h"
+#include "ConnectedComponents.h"
+#include "ThreadPool.h"
+
 #include <iostream>
 #include <fstream>
+#include <queue>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
 using namespace std;
 
+////////////////////////////////////////////////////////////////////////////////
+// CUT EDGES (exact solver)
+// Lattice edges that have been drawn inside the blank area to split it.
+// A horizontal edge is stored by its left vertex, a vertical one by its upper vertex.
+////////////////////////////////////////////////////////////////////////////////
+struct CutEdges
+{
+    int width;
+    int height;
+    vector<bool> horizontal; // (height + 1) * width
+    vector<bool> vertical;   // height * (width + 1)
+
+    CutEdges(int _width, int _height) :
+        width(_width), height(_height),
+        horizontal((_height + 1) * _width, false), vertical(_height * (_width + 1), false) {}
+
+    int Index(const coord2D &_vertex, const coord2D &_dir) const
+    {
+        if (_dir.x != 0)
+            return _vertex.y * width + (_dir.x > 0 ? _vertex.x : _vertex.x - 1);
+        return (_dir.y > 0 ? _vertex.y : _vertex.y - 1) * (width + 1) + _vertex.x;
+    }
+
+    bool EdgeExists(const coord2D &_vertex, const coord2D &_dir) const
+    {
+        coord2D end(_vertex.x + _dir.x, _vertex.y + _dir.y);
+        return (end.x >= 0 && end.x <= width && end.y >= 0 && end.y <= height);
+    }
+
+    bool IsCut(const coord2D &_vertex, const coord2D &_dir) const
+    {
+        if (!EdgeExists(_vertex, _dir))
+            return false;
+        return (_dir.x != 0) ? horizontal[Index(_vertex, _dir)] : vertical[Index(_vertex, _dir)];
+    }
+
+    void Cut(const coord2D &_vertex, const coord2D &_dir)
+    {
+        if (_dir.x != 0)
+            horizontal[Index(_vertex, _dir)] = true;
+        else
+            vertical[Index(_vertex, _dir)] = true;
+    }
+
+    // _ignoredDir skips one of the edges (e.g. the one we arrived from)
+    bool TouchesCut(const coord2D &_vertex, const coord2D &_ignoredDir = coord2D()) const
+    {
+        const coord2D dirs[4] = { coord2D(1, 0), coord2D(-1, 0), coord2D(0, 1), coord2D(0, -1) };
+        for (int d = 0; d < 4; ++d)
+        {
+            if ((dirs[d].x != _ignoredDir.x || dirs[d].y != _ignoredDir.y) && IsCut(_vertex, dirs[d]))
+                return true;
+        }
+        return false;
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 // AUX FUNCTIONS
 ////////////////////////////////////////////////////////////////////////////////
-void Tessellator::Print2DVector(const vector<vector<int>> &grid)
+void Tessellator::Print2DVector(const OccupancyGrid &grid)
 {
-    for (int i = 0; i < grid.size(); i++)
+    for (int i = 0; i < grid.Height(); i++)
     {
-        for (int j = 0; j < grid[i].size(); j++)
+        for (int j = 0; j < grid.Width(); j++)
         {
-            std::cout << grid[i][j] << " ";
+            std::cout << grid.IsOccupied(j, i) << " ";
         }
         std::cout << endl;
     }
 }
 
+void Tessellator::Print2DVector(const vector<vector<int>> &grid)
+{
+    Print2DVector(OccupancyGrid(grid));
+}
+
 void Tessellator::PrintRectangle(const rectangle &rect, const int &gridHeight, const int &gridWidth)
 {
     for (int i = 0; i < gridHeight; i++)
@@ -64,70 +139,56 @@ bool Tessellator::CurrentRectIsOpen(const coord2D &_rect)
     return (_rect.x != -1 && _rect.y != -1);
 }
 
-bool Tessellator::CellIsOccupied(const vector<vector<int>> &initialGrid, const coord2D &_pos)
+bool Tessellator::CellIsOccupied(const OccupancyGrid &initialGrid, const coord2D &_pos)
 {
-    return (initialGrid[_pos.y][_pos.x] == 1);
+    return initialGrid.IsOccupied(_pos.x, _pos.y);
 }
 
-bool Tessellator::PartialRectangleIsCorrect(const vector<vector<int>> &initialGrid, coord2D _currentRectInit, coord2D _currentRectEnd)
+bool Tessellator::PartialRectangleIsCorrect(const OccupancyGrid &initialGrid, coord2D _currentRectInit, coord2D _currentRectEnd)
 {
     if (!CurrentRectIsOpen(_currentRectInit)) // if closed, suppose it correct
     {
         return true;
     }
 
-    for (int i = _currentRectInit.x; i <= _currentRectEnd.x; i++)
+    if (_currentRectEnd.x < _currentRectInit.x)
     {
-        for (int j = _currentRectInit.y; j <= _currentRectEnd.y; j++)
+        return true;
+    }
+
+    // A row span at a time, whole words at once
+    for (int j = _currentRectInit.y; j <= _currentRectEnd.y; j++)
+    {
+        if (!initialGrid.RowSpanIsFree(j, _currentRectInit.x, _currentRectEnd.x))
         {
-            if (CellIsOccupied(initialGrid, coord2D(i, j)))
-            {
-                return false;
-            }
+            return false;
         }
     }
     return true;
 }
 
-void Tessellator::MarkPartialRectangleOccupied(vector<vector<int>> &currentGrid, coord2D _currentRectInit, coord2D _currentRectEnd, int value)
+void Tessellator::MarkPartialRectangleOccupied(OccupancyGrid &currentGrid, coord2D _currentRectInit, coord2D _currentRectEnd, int value)
 {
-    //mark the currentRect as occupied
-    for (int i = _currentRectInit.y; i <= _currentRectEnd.y; i++)
-    {
-        for (int j = _currentRectInit.x; j <= _currentRectEnd.x; j++)
-        {
-            currentGrid[i][j] = value;
-            //Print2DVector(currentGrid);
-            //std::cout << "MARKED " << i << ", " << j << endl;
-        }
-    }
+    //mark the currentRect as occupied (whole words at a time)
+    currentGrid.SetRectangle(_currentRectInit, _currentRectEnd, value != 0);
+    //Print2DVector(currentGrid);
 }
 
-bool Tessellator::IsGridComplete(const vector<vector<int>> &initialGrid)
+bool Tessellator::IsGridComplete(const OccupancyGrid &initialGrid)
 {
-    for (int i = 0; i < initialGrid[0].size(); i++)
-    {
-        for (int j = 0; j < initialGrid.size(); j++)
-        {
-            if (!CellIsOccupied(initialGrid, coord2D(i, j)))
-            {
-                return false;
-            }
-        }
-    }
-    return true;
+    return initialGrid.IsFull();
 }
 
-bool Tessellator::IsValidSolution(const vector<vector<int>> &initialGrid, const coord2D &_currentRect)
+bool Tessellator::IsValidSolution(const OccupancyGrid &initialGrid, const coord2D &_currentRect)
 {
     return (!CurrentRectIsOpen(_currentRect) && IsGridComplete(initialGrid));
 }
 
-bool Tessellator::IsValid(const vector<vector<int>> &occupiedGrid, const coord2D &_pos, const coord2D &_rect)
+bool Tessellator::IsValid(const OccupancyGrid &occupiedGrid, const coord2D &_pos, const coord2D &_rect)
 {
     // If the current cell is out of bounds, this partial solution doesn't work
-    if (_pos.y >= occupiedGrid.size() ||
-        _pos.x >= occupiedGrid[0].size())
+    if (_pos.y >= occupiedGrid.Height() ||
+        _pos.x >= occupiedGrid.Width())
     {
         return false;
     }
@@ -147,29 +208,18 @@ int Tessellator::CalculateRectangleArea(const coord2D &_rectInit, const coord2D
     return ((_rectEnd.x - _rectInit.x + 1) * (_rectEnd.y - _rectInit.y + 1));
 }
 
-int Tessellator::CalculateNumBlanks(const vector<vector<int>> &initialGrid)
+int Tessellator::CalculateNumBlanks(const OccupancyGrid &initialGrid)
 {
-    int numBlanks = 0;
-    for (int i = 0; i < initialGrid[0].size(); i++)
-    {
-        for (int j = 0; j < initialGrid.size(); j++)
-        {
-            if (!CellIsOccupied(initialGrid, coord2D(i, j)))
-            {
-                numBlanks++;
-            }
-        }
-    }
-    return numBlanks;
+    return initialGrid.CountBlanks();
 }
 
 // Returns false in case of NON VALID OPTION for the current state
-bool Tessellator::takeOption(int option, const vector<vector<int>> &marksGrid, const coord2D &_lastPos, const coord2D &_lastRect, coord2D &_nextPos, coord2D &_nextRect,
+bool Tessellator::takeOption(int option, const OccupancyGrid &marksGrid, const coord2D &_lastPos, const coord2D &_lastRect, coord2D &_nextPos, coord2D &_nextRect,
     int &numBlanksClosed)
 {
     // IF POS IS OUT OF BOUNDS THERE IS NOT ANY VALID OPTION
-    if (_lastPos.y >= marksGrid.size() ||
-        _lastPos.x >= marksGrid[0].size())
+    if (_lastPos.y >= marksGrid.Height() ||
+        _lastPos.x >= marksGrid.Width())
     {
         return false;
     }
@@ -238,20 +288,10 @@ bool Tessellator::takeOption(int option, const vector<vector<int>> &marksGrid, c
 
         _nextRect = _lastRect;
 
-        //FIND FIRST
+        //FIND FIRST (row-major, skipping full words)
+        // The marks are undone while backtracking, so it can't resume from a cursor.
         coord2D firstZeroPos = coord2D(-1, -1);
-        {
-            for (int i = 0; i < marksGrid[0].size() && !CurrentRectIsOpen(firstZeroPos); i++)
-            {
-                for (int j = 0; j < marksGrid.size() && !CurrentRectIsOpen(firstZeroPos); j++)
-                {
-                    if (!CellIsOccupied(marksGrid, coord2D(i, j)))
-                    {
-                        firstZeroPos = coord2D(i, j);
-                    }
-                }
-            }
-        }
+        marksGrid.FindFirstBlank(coord2D(0, 0), firstZeroPos);
         _nextPos = firstZeroPos;
         break;
     }
@@ -261,7 +301,7 @@ bool Tessellator::takeOption(int option, const vector<vector<int>> &marksGrid, c
 ////////////////////////////////////////////////////////////////////////////////
 // ALGORITHM
 ////////////////////////////////////////////////////////////////////////////////
-void Tessellator::CalculateRectanglesRecursive(vector<vector<int>> &marksGrid, vector<rectangle> &bestSolution, int &bestCost,
+void Tessellator::CalculateRectanglesRecursive(OccupancyGrid &marksGrid, vector<rectangle> &bestSolution, int &bestCost,
     coord2D _currentPos, coord2D _currentRect, vector<rectangle> &_currentSolution, int &_currentCost,
     int level, int &numBlanks)
 {
@@ -345,73 +385,849 @@ void Tessellator::CalculateRectanglesRecursive(vector<vector<int>> &marksGrid, v
     } //for
 }
 
-void Tessellator::CalculateRectanglesIterative(vector<vector<int>> &marksGrid, vector<rectangle> &solution, int &cost,
-    coord2D _currentPos, coord2D _currentRect, int &numBlanks)
+void Tessellator::CalculateRectanglesIterative(OccupancyGrid &marksGrid, vector<rectangle> &solution, int &cost,
+    int &numBlanks)
 {
     // The iterative algorithm will follow these rules:
-    // 1. Open a new Rectangle in the first blank position
+    // 1. Open a new Rectangle in the first blank position (row-major order)
     // 2. Move rigth (as far as possible)
     // 3. Move down (as far as possible)
     // 4. Close the current rect and repeat from the upper left corner
     // 5. Repeat until the number of Blanks is zero.
 
-    while (numBlanks > 0)
+    // Everything before the last blank found is occupied yet, and cells are never
+    // released here: each search resumes from there instead of the origin.
+    BlankCursor firstBlankCursor(marksGrid);
+
+    rectangle currentRect;
+    while (numBlanks > 0 && NextIterativeRectangle(marksGrid, firstBlankCursor, currentRect))
     {
-        // FIND FIRST RECTANGLE
-        coord2D firstZeroPos = coord2D(-1, -1);
+        numBlanks -= CalculateRectangleArea(currentRect.corner1, currentRect.corner2);
+        solution.push_back(currentRect);
+        cost++;
+    }
+
+}
+
+bool Tessellator::NextIterativeRectangle(OccupancyGrid &marksGrid, BlankCursor &firstBlankCursor, rectangle &rect)
+{
+    // FIND FIRST RECTANGLE
+    coord2D firstZeroPos;
+    if (!firstBlankCursor.Next(firstZeroPos))
+        return false;
+
+    // OPEN NEW RECTANGLE
+    coord2D currentRectPoint1 = firstZeroPos;
+    coord2D currentRectPoint2 = firstZeroPos;
+    coord2D nextPos;
+
+    // MOVE RIGHT (as far as possible: up to the next occupied cell in the row)
+    currentRectPoint2.x = marksGrid.FindNextOccupiedInRow(currentRectPoint1.x, currentRectPoint1.y) - 1;
+
+    // MOVE DOWN (while the next row is free under the whole rectangle)
+    // The rows above are checked yet, so only the new one is scanned, a word at a time.
+    nextPos = coord2D(currentRectPoint2.x, currentRectPoint2.y + 1);
+    while (nextPos.y < marksGrid.Height() && marksGrid.RowSpanIsFree(nextPos.y, currentRectPoint1.x, currentRectPoint2.x))
+    {
+        currentRectPoint2 = nextPos;
+        nextPos = coord2D(currentRectPoint2.x, currentRectPoint2.y + 1);
+    }
+
+    // CLOSE CURRENT RECT
+    MarkPartialRectangleOccupied(marksGrid, currentRectPoint1, currentRectPoint2, 1);
+    rect = rectangle(currentRectPoint1, currentRectPoint2);
+    return true;
+}
+
+void Tessellator::CalculateRectanglesRunLength(RunLengthGrid &marksGrid, vector<rectangle> &solution, int &cost)
+{
+    // The first blank is always the start of a run: everything before it is occupied
+    coord2D anchor(0, 0);
+    while (marksGrid.FindFirstBlank(anchor, anchor))
+    {
+        // MOVE RIGHT
+        int right = marksGrid.RunEnd(anchor.x, anchor.y);
+
+        // MOVE DOWN
+        int bottom = anchor.y;
+        while (bottom + 1 < marksGrid.Height() && marksGrid.SpanIsBlank(bottom + 1, anchor.x, right))
         {
-            for (int i = 0; i < marksGrid[0].size() && !CurrentRectIsOpen(firstZeroPos); i++)
+            bottom++;
+        }
+
+        marksGrid.MarkOccupied(anchor, coord2D(right, bottom));
+        solution.push_back(rectangle(anchor, coord2D(right, bottom)));
+        cost++;
+    }
+}
+
+bool Tessellator::CalculateRectanglesSmallBlock(const OccupancyGrid &grid, vector<rectangle> &solution, int &cost)
+{
+    if (grid.Width() > SMALL_BLOCK_SIZE || grid.Height() > SMALL_BLOCK_SIZE)
+        return false;
+
+    // Cells out of the grid are occupied in the block
+    uint16_t occupiedMask = 0;
+    for (int y = 0; y < SMALL_BLOCK_SIZE; ++y)
+    {
+        for (int x = 0; x < SMALL_BLOCK_SIZE; ++x)
+        {
+            if (x >= grid.Width() || y >= grid.Height() || grid.IsOccupied(x, y))
             {
-                for (int j = 0; j < marksGrid.size() && !CurrentRectIsOpen(firstZeroPos); j++)
-                {
-                    if (!CellIsOccupied(marksGrid, coord2D(i, j)))
-                    {
-                        firstZeroPos = coord2D(i, j);
-                    }
-                }
+                occupiedMask |= 1 << (y * SMALL_BLOCK_SIZE + x);
             }
         }
+    }
+    cost += SmallBlockPartition(occupiedMask, solution);
+    return true;
+}
 
-        // OPEN NEW RECTANGLE
-        coord2D currentRectPoint1 = firstZeroPos;
-        coord2D currentRectPoint2 = firstZeroPos;
-        coord2D nextPos;
+void Tessellator::CalculateRectanglesLargestEmpty(OccupancyGrid &marksGrid, vector<rectangle> &solution, int &cost)
+{
+    LargestEmptyRectangles carver(marksGrid);
+    rectangle rect;
+    while (carver.Next(rect))
+    {
+        MarkPartialRectangleOccupied(marksGrid, rect.corner1, rect.corner2, 1);
+        solution.push_back(rect);
+        cost++;
+    }
+}
 
-        // MOVE RIGHT
-        nextPos = coord2D(currentRectPoint2.x + 1, currentRectPoint2.y);
-        while (nextPos.x < marksGrid[0].size() && !CellIsOccupied(marksGrid, nextPos))
+void Tessellator::CalculateRectanglesExact(OccupancyGrid &marksGrid, vector<rectangle> &solution, int &cost)
+{
+    // Minimum partition of a rectilinear area into rectangles (polynomial time):
+    // 1. Find the "good chords": horizontal or vertical segments through the blank area
+    //    that join two concave vertices.
+    // 2. Take a maximum set of non-intersecting chords. Horizontal and vertical chords form
+    //    a bipartite intersection graph, so it is the complement of a minimum vertex cover,
+    //    obtained from a maximum matching (Hopcroft-Karp + Konig).
+    // 3. Draw those chords, and resolve every concave vertex still untouched with a single
+    //    cut along one of its extensions, until it hits a wall or another cut.
+    // 4. Every face left has no concave vertex, so it is a rectangle.
+    // The result has (concave vertices - chords taken + components - holes) rectangles,
+    // which is the proven minimum.
+
+    if (marksGrid.Empty())
+    {
+        return;
+    }
+
+    int width = marksGrid.Width();
+    int height = marksGrid.Height();
+
+    // 1. GOOD CHORDS
+    vector<chord> hChords;
+    vector<chord> vChords;
+    FindChords(marksGrid, hChords, vChords);
+
+    // 2. MAXIMUM SET OF NON-INTERSECTING CHORDS
+    // Chords of the same orientation never share a vertex, so every vertex belongs to
+    // one horizontal chord at most.
+    vector<int> hChordAtVertex((width + 1) * (height + 1), -1);
+    for (int h = 0; h < hChords.size(); ++h)
+    {
+        for (int x = hChords[h].from.x; x <= hChords[h].to.x; ++x)
         {
-            currentRectPoint2 = nextPos;
-            nextPos = coord2D(currentRectPoint2.x + 1, currentRectPoint2.y);
+            hChordAtVertex[hChords[h].from.y * (width + 1) + x] = h;
         }
+    }
 
-        // MOVE DOWN
-        nextPos = coord2D(currentRectPoint2.x, currentRectPoint2.y + 1);
-        while (nextPos.y < marksGrid.size() && !CellIsOccupied(marksGrid, nextPos) && PartialRectangleIsCorrect(marksGrid, currentRectPoint1, nextPos))
+    HopcroftKarp matching(hChords.size(), vChords.size());
+    for (int v = 0; v < vChords.size(); ++v)
+    {
+        for (int y = vChords[v].from.y; y <= vChords[v].to.y; ++y)
         {
-            currentRectPoint2 = nextPos;
-            nextPos = coord2D(currentRectPoint2.x, currentRectPoint2.y + 1);
+            int h = hChordAtVertex[y * (width + 1) + vChords[v].from.x];
+            if (h != -1)
+            {
+                matching.AddEdge(h, v);
+            }
         }
+    }
+    matching.MaximumMatching();
 
-        // CLOSE CURRENT RECT
-        numBlanks -= CalculateRectangleArea(currentRectPoint1, currentRectPoint2);
-        MarkPartialRectangleOccupied(marksGrid, currentRectPoint1, currentRectPoint2, 1);
-        solution.push_back(rectangle(currentRectPoint1, currentRectPoint2));
-        cost++;
+    vector<bool> hChordTaken;
+    vector<bool> vChordTaken;
+    matching.MaximumIndependentSet(hChordTaken, vChordTaken);
+
+    // 3. DRAW THE CUTS
+    CutEdges cuts(width, height);
+    for (int h = 0; h < hChords.size(); ++h)
+    {
+        if (hChordTaken[h])
+        {
+            for (int x = hChords[h].from.x; x < hChords[h].to.x; ++x)
+            {
+                cuts.Cut(coord2D(x, hChords[h].from.y), coord2D(1, 0));
+            }
+        }
+    }
+    for (int v = 0; v < vChords.size(); ++v)
+    {
+        if (vChordTaken[v])
+        {
+            for (int y = vChords[v].from.y; y < vChords[v].to.y; ++y)
+            {
+                cuts.Cut(coord2D(vChords[v].from.x, y), coord2D(0, 1));
+            }
+        }
+    }
+
+    for (int vy = 0; vy <= height; ++vy)
+    {
+        for (int vx = 0; vx <= width; ++vx)
+        {
+            if (NumBlankCellsAroundVertex(marksGrid, vx, vy) != 3)
+                continue;
+
+            coord2D vertex(vx, vy);
+            if (cuts.TouchesCut(vertex)) // resolved yet
+                continue;
+
+            // EXTEND VERTICALLY until a wall or another cut is reached
+            coord2D dir(0, ConcaveVertexExtension(marksGrid, vx, vy).y);
+            do
+            {
+                cuts.Cut(vertex, dir);
+                vertex = coord2D(vertex.x + dir.x, vertex.y + dir.y);
+            } while (NumBlankCellsAroundVertex(marksGrid, vertex.x, vertex.y) == 4 &&
+                !cuts.TouchesCut(vertex, coord2D(-dir.x, -dir.y)));
+        }
+    }
+
+    // 4. COLLECT THE FACES
+    vector<bool> visited(width * height, false);
+    queue<coord2D> pending;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            if (visited[y * width + x] || !CellIsBlank(marksGrid, x, y))
+                continue;
+
+            coord2D corner1(x, y);
+            coord2D corner2(x, y);
+            visited[y * width + x] = true;
+            pending.push(coord2D(x, y));
+            while (!pending.empty())
+            {
+                coord2D cell = pending.front();
+                pending.pop();
+                corner1 = coord2D(min(corner1.x, cell.x), min(corner1.y, cell.y));
+                corner2 = coord2D(max(corner2.x, cell.x), max(corner2.y, cell.y));
+
+                // The edge crossed to reach each neighbour, described from one of its vertices
+                const coord2D neighbours[4] = { coord2D(1, 0), coord2D(-1, 0), coord2D(0, 1), coord2D(0, -1) };
+                const coord2D edgeVertex[4] = { coord2D(cell.x + 1, cell.y), coord2D(cell.x, cell.y),
+                                                coord2D(cell.x, cell.y + 1), coord2D(cell.x, cell.y) };
+                const coord2D edgeDir[4] = { coord2D(0, 1), coord2D(0, 1), coord2D(1, 0), coord2D(1, 0) };
+                for (int n = 0; n < 4; ++n)
+                {
+                    int nx = cell.x + neighbours[n].x;
+                    int ny = cell.y + neighbours[n].y;
+                    if (!CellIsBlank(marksGrid, nx, ny) || visited[ny * width + nx] ||
+                        cuts.IsCut(edgeVertex[n], edgeDir[n]))
+                        continue;
+
+                    visited[ny * width + nx] = true;
+                    pending.push(coord2D(nx, ny));
+                }
+            }
+
+            // CLOSE CURRENT RECT
+            MarkPartialRectangleOccupied(marksGrid, corner1, corner2, 1);
+            solution.push_back(rectangle(corner1, corner2));
+            cost++;
+        }
     }
+}
+
+bool Tessellator::CalculateRectanglesBranchAndBound(OccupancyGrid &marksGrid, vector<rectangle> &solution, int &cost,
+    long long maxNodes, int numThreads)
+{
+    BranchAndBoundSolver solver(marksGrid, maxNodes);
+
+    // The greedy solution is the first bound to beat
+    OccupancyGrid greedyGrid = marksGrid;
+    vector<rectangle> greedySolution;
+    int greedyCost = 0;
+    int numBlanks = CalculateNumBlanks(greedyGrid);
+    CalculateRectanglesIterative(greedyGrid, greedySolution, greedyCost, numBlanks);
+    solver.SetIncumbent(greedySolution);
 
+    vector<rectangle> bestSolution;
+    bool isOptimal = solver.Solve(bestSolution, numThreads);
+    for (int i = 0; i < bestSolution.size(); ++i)
+    {
+        MarkPartialRectangleOccupied(marksGrid, bestSolution[i].corner1, bestSolution[i].corner2, 1);
+    }
+    solution.insert(solution.end(), bestSolution.begin(), bestSolution.end());
+    cost += bestSolution.size();
+    return isOptimal;
+}
+
+int Tessellator::CalculateRectangles(const vector<vector<int>> &initialGrid, vector<rectangle> &solution,
+    TessellationMode mode)
+{
+    return CalculateRectangles(OccupancyGrid(initialGrid), solution, mode);
+}
+
+int Tessellator::CalculateRectangles(RunLengthGrid copyGrid, vector<rectangle> &solution,
+    TessellationMode mode)
+{
+    if (mode != TessellationMode::ITERATIVE)
+    {
+        return CalculateRectangles(copyGrid.ToOccupancyGrid(), solution, mode);
+    }
+
+    int numRects = 0;
+    CalculateRectanglesRunLength(copyGrid, solution, numRects);
+    return numRects;
 }
 
-int Tessellator::CalculateRectangles(const vector<vector<int>> &initialGrid, vector<rectangle> &solution)
+int Tessellator::CalculateRectangles(OccupancyGrid copyGrid, vector<rectangle> &solution,
+    TessellationMode mode)
 {
-    vector<vector<int>> copyGrid = initialGrid;
+    // copyGrid is taken by value: it will be marked while solving.
+    // Move the grid in when the caller doesn't need it anymore.
     int numBlanks = CalculateNumBlanks(copyGrid);
     int numRects = 0;
-    int tempCost = 0;
+    //int tempCost = 0;
     //CalculateRectanglesRecursive(copyGrid, solution, numRects,
     //    coord2D(0, 0), coord2D(-1, -1), vector<rectangle>(), tempCost,
     //    0, numBlanks);
-    CalculateRectanglesIterative(copyGrid, solution, numRects,
-        coord2D(0, 0), coord2D(-1, -1), numBlanks);
+    switch (mode)
+    {
+    case TessellationMode::ITERATIVE:
+        CalculateRectanglesIterative(copyGrid, solution, numRects, numBlanks);
+        break;
+
+    case TessellationMode::LARGEST_EMPTY:
+        CalculateRectanglesLargestEmpty(copyGrid, solution, numRects);
+        break;
+
+    case TessellationMode::EXACT:
+        CalculateRectanglesExact(copyGrid, solution, numRects);
+        break;
+
+    case TessellationMode::BRANCH_AND_BOUND:
+        CalculateRectanglesBranchAndBound(copyGrid, solution, numRects);
+        break;
+
+    case TessellationMode::PARALLEL_BRANCH_AND_BOUND:
+        CalculateRectanglesBranchAndBound(copyGrid, solution, numRects, 2000000, 0);
+        break;
+
+    case TessellationMode::PORTFOLIO:
+        numRects = CalculateRectanglesPortfolio(copyGrid, solution);
+        break;
+    }
     return numRects;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// PARALLEL
+////////////////////////////////////////////////////////////////////////////////
+int Tessellator::CalculateRectanglesTiled(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+    TessellationMode tileMode, int numThreads, int bandHeight, TiledStats *stats)
+{
+    // The bands only depend on bandHeight, and their results are put together in
+    // band order: the output is the same whatever the number of threads.
+    TiledStats tiledStats;
+    int numBands = (initialGrid.Height() + bandHeight - 1) / bandHeight;
+    vector<vector<rectangle>> bandSolutions(numBands);
+    {
+        SharedPool pool(numThreads);
+        TaskGroup tasks;
+        for (int b = 0; b < numBands; ++b)
+        {
+            pool->Submit([this, &initialGrid, &bandSolutions, tileMode, bandHeight, b]()
+            {
+                int firstRow = b * bandHeight;
+                int lastRow = min(initialGrid.Height(), firstRow + bandHeight) - 1;
+                OccupancyGrid band = initialGrid.Crop(coord2D(0, firstRow), coord2D(initialGrid.Width() - 1, lastRow));
+                CalculateRectangles(std::move(band), bandSolutions[b], tileMode);
+
+                // Back to grid coordinates
+                for (int r = 0; r < bandSolutions[b].size(); ++r)
+                {
+                    bandSolutions[b][r].corner1.y += firstRow;
+                    bandSolutions[b][r].corner2.y += firstRow;
+                }
+            }, &tasks);
+        }
+        pool->Wait(tasks);
+    }
+
+    vector<rectangle> rects;
+    for (int b = 0; b < numBands; ++b)
+    {
+        rects.insert(rects.end(), bandSolutions[b].begin(), bandSolutions[b].end());
+    }
+    tiledStats.numTiles = numBands;
+    tiledStats.numRectsBeforeMerge = rects.size();
+
+    MergeAcrossSeams(rects, initialGrid, bandHeight, tiledStats);
+    solution.insert(solution.end(), rects.begin(), rects.end());
+
+    if (stats != NULL)
+    {
+        *stats = tiledStats;
+    }
+    return rects.size();
+}
+
+int Tessellator::CalculateRectanglesByComponents(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+    TessellationMode mode, int numThreads)
+{
+    ConnectedComponents components(initialGrid);
+
+    vector<vector<rectangle>> componentSolutions(components.Size());
+    {
+        SharedPool pool(numThreads);
+        TaskGroup tasks;
+        for (int c = 0; c < components.Size(); ++c)
+        {
+            pool->Submit([this, &components, &componentSolutions, mode, c]()
+            {
+                OccupancyGrid componentGrid = components.ExtractGrid(c);
+                int numComponentRects = 0;
+                if (!CalculateRectanglesSmallBlock(componentGrid, componentSolutions[c], numComponentRects))
+                {
+                    CalculateRectangles(std::move(componentGrid), componentSolutions[c], mode);
+                }
+                OffsetRectangles(componentSolutions[c], components[c].boundingBox.corner1);
+            }, &tasks);
+        }
+        pool->Wait(tasks);
+    }
+
+    int numRects = 0;
+    for (int c = 0; c < components.Size(); ++c)
+    {
+        solution.insert(solution.end(), componentSolutions[c].begin(), componentSolutions[c].end());
+        numRects += componentSolutions[c].size();
+    }
+    return numRects;
+}
+
+int Tessellator::CalculateRectanglesPortfolio(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+    int numThreads)
+{
+    const TessellationMode engines[] = { TessellationMode::ITERATIVE, TessellationMode::LARGEST_EMPTY };
+    const int numEngines = sizeof(engines) / sizeof(engines[0]);
+    const int numOrientations = 8; // bits: transpose, mirror x, mirror y
+    const int numVariants = numEngines * numOrientations;
+
+    vector<vector<rectangle>> variantSolutions(numVariants);
+    {
+        // Reached from the tasks of tiles or components: share their pool, also when the
+        // task runs on the thread waiting for them
+        SharedPool pool(numThreads);
+        TaskGroup tasks;
+        for (int v = 0; v < numVariants; ++v)
+        {
+            pool->Submit([this, &initialGrid, &variantSolutions, &engines, v]()
+            {
+                bool transpose = (v & 1) != 0;
+                bool mirrorX = (v & 2) != 0;
+                bool mirrorY = (v & 4) != 0;
+                OccupancyGrid oriented = initialGrid.Oriented(transpose, mirrorX, mirrorY);
+                int orientedWidth = oriented.Width();
+                int orientedHeight = oriented.Height();
+                CalculateRectangles(std::move(oriented), variantSolutions[v], engines[v / numOrientations]);
+
+                // Back to the original orientation: undo the mirrors, then the transpose
+                for (int r = 0; r < variantSolutions[v].size(); ++r)
+                {
+                    rectangle &rect = variantSolutions[v][r];
+                    int x0 = rect.corner1.x, y0 = rect.corner1.y;
+                    int x1 = rect.corner2.x, y1 = rect.corner2.y;
+                    if (mirrorX)
+                    {
+                        x0 = orientedWidth - 1 - rect.corner2.x;
+                        x1 = orientedWidth - 1 - rect.corner1.x;
+                    }
+                    if (mirrorY)
+                    {
+                        y0 = orientedHeight - 1 - rect.corner2.y;
+                        y1 = orientedHeight - 1 - rect.corner1.y;
+                    }
+                    rect = transpose ? rectangle(coord2D(y0, x0), coord2D(y1, x1)) :
+                        rectangle(coord2D(x0, y0), coord2D(x1, y1));
+                }
+            }, &tasks);
+        }
+        pool->Wait(tasks);
+    }
+
+    // PICK: fewest rectangles, then smallest total perimeter
+    int best = 0;
+    long long bestPerimeter = -1;
+    for (int v = 0; v < numVariants; ++v)
+    {
+        long long perimeter = 0;
+        for (int r = 0; r < variantSolutions[v].size(); ++r)
+        {
+            const rectangle &rect = variantSolutions[v][r];
+            perimeter += 2 * (rect.corner2.x - rect.corner1.x + 1) + 2 * (rect.corner2.y - rect.corner1.y + 1);
+        }
+
+        if (bestPerimeter < 0 ||
+            variantSolutions[v].size() < variantSolutions[best].size() ||
+            (variantSolutions[v].size() == variantSolutions[best].size() && perimeter < bestPerimeter))
+        {
+            best = v;
+            bestPerimeter = perimeter;
+        }
+    }
+
+    solution.insert(solution.end(), variantSolutions[best].begin(), variantSolutions[best].end());
+    return variantSolutions[best].size();
+}
+
+int Tessellator::CalculateRectanglesAnytime(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+    double timeBudgetSeconds, ProgressCallback onImprovement)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ConnectedComponents components(initialGrid);
+
+    // GREEDY
+    vector<vector<rectangle>> componentSolutions(components.Size());
+    int numRects = 0;
+    for (int c = 0; c < components.Size(); ++c)
+    {
+        OccupancyGrid componentGrid = components.ExtractGrid(c);
+        int numComponentRects = 0;
+        if (!CalculateRectanglesSmallBlock(componentGrid, componentSolutions[c], numComponentRects))
+        {
+            CalculateRectangles(std::move(componentGrid), componentSolutions[c], TessellationMode::ITERATIVE);
+        }
+        OffsetRectangles(componentSolutions[c], components[c].boundingBox.corner1);
+        numRects += componentSolutions[c].size();
+    }
+    if (onImprovement)
+    {
+        onImprovement(numRects, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+
+    // IMPROVE: most greedy rectangles first (the most to gain)
+    vector<int> order(components.Size());
+    for (int c = 0; c < order.size(); ++c)
+    {
+        order[c] = c;
+    }
+    stable_sort(order.begin(), order.end(), [&componentSolutions](int a, int b)
+    {
+        return componentSolutions[a].size() > componentSolutions[b].size();
+    });
+
+    for (int i = 0; i < order.size(); ++i)
+    {
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (elapsed >= timeBudgetSeconds)
+            break;
+
+        int c = order[i];
+        if (componentSolutions[c].size() <= 1)
+            break; // the rest are single rectangles already
+
+        vector<rectangle> exactSolution;
+        CalculateRectangles(components.ExtractGrid(c), exactSolution, TessellationMode::EXACT);
+        if (exactSolution.size() < componentSolutions[c].size())
+        {
+            OffsetRectangles(exactSolution, components[c].boundingBox.corner1);
+            numRects -= componentSolutions[c].size() - exactSolution.size();
+            componentSolutions[c].swap(exactSolution);
+            if (onImprovement)
+            {
+                onImprovement(numRects, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            }
+        }
+    }
+
+    for (int c = 0; c < components.Size(); ++c)
+    {
+        solution.insert(solution.end(), componentSolutions[c].begin(), componentSolutions[c].end());
+    }
+    return numRects;
+}
+
+int Tessellator::RetessellateChanges(const OccupancyGrid &newGrid, const vector<coord2D> &changedCells,
+    vector<rectangle> &solution, vector<rectangle> &removed, vector<rectangle> &added, TessellationMode mode)
+{
+    SolutionIndex index(newGrid.Width(), newGrid.Height(), solution);
+    return RetessellateChanges(newGrid, changedCells, solution, index, removed, added, mode);
+}
+
+int Tessellator::RetessellateChanges(const OccupancyGrid &newGrid, const vector<coord2D> &changedCells,
+    vector<rectangle> &solution, SolutionIndex &index, vector<rectangle> &removed, vector<rectangle> &added,
+    TessellationMode mode)
+{
+    if (changedCells.empty())
+        return solution.size();
+
+    // FREE the rectangles over a changed cell or next to it (so they can grow into it):
+    // the ones with a cell among the 9 around a changed cell
+    vector<int> freedIds;
+    vector<rectangle> freed;
+    for (int c = 0; c < changedCells.size(); ++c)
+    {
+        for (int y = changedCells[c].y - 1; y <= changedCells[c].y + 1; ++y)
+        {
+            for (int x = changedCells[c].x - 1; x <= changedCells[c].x + 1; ++x)
+            {
+                int id = index.RectangleAt(x, y);
+                if (id >= 0)
+                {
+                    freedIds.push_back(id);
+                }
+            }
+        }
+    }
+    sort(freedIds.begin(), freedIds.end());
+    freedIds.erase(unique(freedIds.begin(), freedIds.end()), freedIds.end());
+    for (int r = 0; r < freedIds.size(); ++r)
+    {
+        freed.push_back(index.Rectangle(solution, freedIds[r]));
+    }
+
+    // REGION to solve again: the freed rectangles and the changed cells
+    coord2D regionInit = changedCells[0];
+    coord2D regionEnd = changedCells[0];
+    for (int r = 0; r < freed.size(); ++r)
+    {
+        regionInit = coord2D(min(regionInit.x, freed[r].corner1.x), min(regionInit.y, freed[r].corner1.y));
+        regionEnd = coord2D(max(regionEnd.x, freed[r].corner2.x), max(regionEnd.y, freed[r].corner2.y));
+    }
+    for (int c = 0; c < changedCells.size(); ++c)
+    {
+        regionInit = coord2D(min(regionInit.x, changedCells[c].x), min(regionInit.y, changedCells[c].y));
+        regionEnd = coord2D(max(regionEnd.x, changedCells[c].x), max(regionEnd.y, changedCells[c].y));
+    }
+
+    // Everything in the region is occupied but the freed rectangles and the new blanks.
+    // The cells of a freed rectangle were blank unless they have just changed.
+    OccupancyGrid regionGrid(regionEnd.x - regionInit.x + 1, regionEnd.y - regionInit.y + 1);
+    regionGrid.SetRectangle(coord2D(0, 0), coord2D(regionGrid.Width() - 1, regionGrid.Height() - 1), true);
+    for (int r = 0; r < freed.size(); ++r)
+    {
+        regionGrid.SetRectangle(coord2D(freed[r].corner1.x - regionInit.x, freed[r].corner1.y - regionInit.y),
+            coord2D(freed[r].corner2.x - regionInit.x, freed[r].corner2.y - regionInit.y), false);
+    }
+    for (int c = 0; c < changedCells.size(); ++c)
+    {
+        const coord2D &cell = changedCells[c];
+        regionGrid.Set(cell.x - regionInit.x, cell.y - regionInit.y, newGrid.IsOccupied(cell.x, cell.y));
+    }
+
+    vector<rectangle> resolved;
+    CalculateRectangles(std::move(regionGrid), resolved, mode);
+    OffsetRectangles(resolved, regionInit);
+
+    // DELTA: the rectangles that came back the same stay out of it
+    map<pair<pair<int, int>, pair<int, int>>, int> freedCount;
+    for (int r = 0; r < freed.size(); ++r)
+    {
+        freedCount[make_pair(make_pair(freed[r].corner1.x, freed[r].corner1.y), make_pair(freed[r].corner2.x, freed[r].corner2.y))]++;
+    }
+    for (int r = 0; r < resolved.size(); ++r)
+    {
+        map<pair<pair<int, int>, pair<int, int>>, int>::iterator same = freedCount.find(
+            make_pair(make_pair(resolved[r].corner1.x, resolved[r].corner1.y), make_pair(resolved[r].corner2.x, resolved[r].corner2.y)));
+        if (same != freedCount.end() && same->second > 0)
+        {
+            same->second--;
+        }
+        else
+        {
+            added.push_back(resolved[r]);
+        }
+    }
+    for (int r = 0; r < freed.size(); ++r)
+    {
+        int &count = freedCount[make_pair(make_pair(freed[r].corner1.x, freed[r].corner1.y), make_pair(freed[r].corner2.x, freed[r].corner2.y))];
+        if (count > 0)
+        {
+            count--;
+            removed.push_back(freed[r]);
+        }
+    }
+
+    // UPDATE the solution and its index
+    for (int r = 0; r < freedIds.size(); ++r)
+    {
+        index.Remove(solution, freedIds[r]);
+    }
+    for (int r = 0; r < resolved.size(); ++r)
+    {
+        index.Add(solution, resolved[r]);
+    }
+    return solution.size();
+}
+
+int Tessellator::OptimizeRectangles(vector<rectangle> &solution, long long maxMoves)
+{
+    RectangleOptimizer optimizer(solution);
+    optimizer.Run(maxMoves);
+    solution.clear();
+    optimizer.GetRectangles(solution);
+    return solution.size();
+}
+
+void Tessellator::OffsetRectangles(vector<rectangle> &rects, const coord2D &origin)
+{
+    for (int r = 0; r < rects.size(); ++r)
+    {
+        rects[r] = rectangle(coord2D(rects[r].corner1.x + origin.x, rects[r].corner1.y + origin.y),
+            coord2D(rects[r].corner2.x + origin.x, rects[r].corner2.y + origin.y));
+    }
+}
+
+void Tessellator::MergeAcrossSeams(vector<rectangle> &rects, const OccupancyGrid &initialGrid, int bandHeight, TiledStats &stats)
+{
+    // Seams are processed from top to bottom, so a rectangle merged once can keep
+    // growing down through the next seams.
+    // Rectangles ending on the same row never share their left column: (corner1.x)
+    // identifies them, and the width must match to be joined.
+    vector<bool> alive(rects.size(), true);
+    for (int seamY = bandHeight; seamY < initialGrid.Height(); seamY += bandHeight)
+    {
+        unordered_map<int, int> endingAtSeam; // corner1.x -> rect index
+        for (int r = 0; r < rects.size(); ++r)
+        {
+            if (alive[r] && rects[r].corner2.y == seamY - 1)
+            {
+                endingAtSeam[rects[r].corner1.x] = r;
+            }
+        }
+
+        for (int r = 0; r < rects.size(); ++r)
+        {
+            if (!alive[r] || rects[r].corner1.y != seamY)
+                continue;
+
+            unordered_map<int, int>::iterator upper = endingAtSeam.find(rects[r].corner1.x);
+            if (upper != endingAtSeam.end() && rects[upper->second].corner2.x == rects[r].corner2.x)
+            {
+                rects[upper->second].corner2.y = rects[r].corner2.y;
+                alive[r] = false;
+                stats.numMerged++;
+            }
+            else
+            {
+                // Some blank right above it: the seam has cut the area here
+                for (int x = rects[r].corner1.x; x <= rects[r].corner2.x; ++x)
+                {
+                    if (!initialGrid.IsOccupied(x, seamY - 1))
+                    {
+                        stats.numUnmergedAtSeams++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    int numAlive = 0;
+    for (int r = 0; r < rects.size(); ++r)
+    {
+        if (alive[r])
+        {
+            rects[numAlive++] = rects[r];
+        }
+    }
+    rects.resize(numAlive);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EXACT SOLVER AUX FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+bool Tessellator::CellIsBlank(const OccupancyGrid &grid, int x, int y)
+{
+    // Out of bounds counts as occupied
+    if (y < 0 || y >= grid.Height() || x < 0 || x >= grid.Width())
+    {
+        return false;
+    }
+    return !CellIsOccupied(grid, coord2D(x, y));
+}
+
+int Tessellator::NumBlankCellsAroundVertex(const OccupancyGrid &grid, int vx, int vy)
+{
+    return CellIsBlank(grid, vx - 1, vy - 1) + CellIsBlank(grid, vx, vy - 1) +
+        CellIsBlank(grid, vx - 1, vy) + CellIsBlank(grid, vx, vy);
+}
+
+coord2D Tessellator::ConcaveVertexExtension(const OccupancyGrid &grid, int vx, int vy)
+{
+    // A concave vertex has 3 blank cells around it. Its two extensions continue the
+    // two walls that meet there, away from the occupied cell:
+    //
+    //   occupied NE:   . X      extensions: West (-1) and South (+1)
+    //                  . .
+    bool occupiedEast = !CellIsBlank(grid, vx, vy - 1) || !CellIsBlank(grid, vx, vy);
+    bool occupiedNorth = !CellIsBlank(grid, vx - 1, vy - 1) || !CellIsBlank(grid, vx, vy - 1);
+    return coord2D(occupiedEast ? -1 : 1, occupiedNorth ? 1 : -1);
+}
+
+bool Tessellator::EdgeIsInterior(const OccupancyGrid &grid, const coord2D &_vertex, const coord2D &_dir)
+{
+    // An edge is interior when both cells at its sides are blank
+    if (_dir.x != 0)
+    {
+        int cellX = (_dir.x > 0) ? _vertex.x : _vertex.x - 1;
+        return CellIsBlank(grid, cellX, _vertex.y - 1) && CellIsBlank(grid, cellX, _vertex.y);
+    }
+    int cellY = (_dir.y > 0) ? _vertex.y : _vertex.y - 1;
+    return CellIsBlank(grid, _vertex.x - 1, cellY) && CellIsBlank(grid, _vertex.x, cellY);
+}
+
+void Tessellator::FindChords(const OccupancyGrid &grid, vector<chord> &hChords, vector<chord> &vChords)
+{
+    // From each concave vertex, walk East (or South) along its extension while the vertices
+    // found are surrounded by blanks. If the walk stops at another concave vertex, both are
+    // joined by a chord. Walks never overlap, so this is linear in the grid size.
+    int width = grid.Width();
+    int height = grid.Height();
+
+    for (int vy = 0; vy <= height; ++vy)
+    {
+        for (int vx = 0; vx <= width; ++vx)
+        {
+            if (NumBlankCellsAroundVertex(grid, vx, vy) != 3)
+                continue;
+
+            coord2D extension = ConcaveVertexExtension(grid, vx, vy);
+
+            // HORIZONTAL (only the West->East walks, each chord is found once)
+            if (extension.x > 0 && EdgeIsInterior(grid, coord2D(vx, vy), coord2D(1, 0)))
+            {
+                int x = vx + 1;
+                while (NumBlankCellsAroundVertex(grid, x, vy) == 4)
+                {
+                    x++;
+                }
+                if (NumBlankCellsAroundVertex(grid, x, vy) == 3)
+                {
+                    hChords.push_back(chord(coord2D(vx, vy), coord2D(x, vy)));
+                }
+            }
+
+            // VERTICAL (only the North->South walks)
+            if (extension.y > 0 && EdgeIsInterior(grid, coord2D(vx, vy), coord2D(0, 1)))
+            {
+                int y = vy + 1;
+                while (NumBlankCellsAroundVertex(grid, vx, y) == 4)
+                {
+                    y++;
+                }
+                if (NumBlankCellsAroundVertex(grid, vx, y) == 3)
+                {
+                    vChords.push_back(chord(coord2D(vx, vy), coord2D(vx, y)));
+                }
+            }
+        }
+    }
+}
@@ -1,9 +1,39 @@
 #pragma once
 #include <vector>
+#include <cstddef>
+#include <functional>
 
 using namespace std;
 
 #include "AuxStructures.h"
+#include "OccupancyGrid.h"
+#include "RunLengthGrid.h"
+#include "SolutionIndex.h"
+
+enum class TessellationMode
+{
+    ITERATIVE,  // Greedy: open in the first blank, move right, move down
+    LARGEST_EMPTY, // Greedy: carve the largest empty rectangle left, again and again
+    EXACT,      // Minimum partition (concave-vertex chords + bipartite matching)
+    BRANCH_AND_BOUND, // Exhaustive search with pruning, bounded by a node budget
+    PARALLEL_BRANCH_AND_BOUND, // Same search, subtrees spread over all the cores
+    PORTFOLIO   // Both greedies in every orientation, raced on all the cores
+};
+
+// Report of a tiled (parallel) tessellation
+struct TiledStats
+{
+    int numTiles;
+    int numRectsBeforeMerge;
+    int numMerged;           // rectangles joined with the one across a seam
+    int numUnmergedAtSeams;  // rectangles still cut by a seam: margin paid for the tiling
+
+    TiledStats() :
+        numTiles(0), numRectsBeforeMerge(0), numMerged(0), numUnmergedAtSeams(0) {}
+};
+
+// Called by the anytime solver with every better solution found
+typedef function<void(int numRects, double elapsedSeconds)> ProgressCallback;
 
 class Tessellator {
 
@@ -11,33 +41,102 @@ public:
     ////////////////////////////////////////////////////////////////////////////
     // AUX FUNCTIONS
     ////////////////////////////////////////////////////////////////////////////
+    void Print2DVector(const OccupancyGrid &grid);
     void Print2DVector(const vector<vector<int>> &grid);
     void PrintRectangle(const rectangle &rect, const int &gridHeight, const int &gridWidth);
     void PrintRectangleFile(char *filename, const rectangle &rect, const int &gridHeight, const int &gridWidth);
 
     bool CurrentRectIsOpen(const coord2D &_rect);
-    bool CellIsOccupied(const vector<vector<int>> &initialGrid, const coord2D &_pos);
-    bool PartialRectangleIsCorrect(const vector<vector<int>> &initialGrid, coord2D _currentRectInit, coord2D _currentRectEnd);
-    void MarkPartialRectangleOccupied(vector<vector<int>> &currentGrid, coord2D _currentRectInit, coord2D _currentRectEnd, int value);
-    bool IsGridComplete(const vector<vector<int>> &initialGrid);
-    bool IsValidSolution(const vector<vector<int>> &initialGrid, const coord2D &_currentRect);
-    bool IsValid(const vector<vector<int>> &occupiedGrid, const coord2D &_pos, const coord2D &_rect);
+    bool CellIsOccupied(const OccupancyGrid &initialGrid, const coord2D &_pos);
+    bool PartialRectangleIsCorrect(const OccupancyGrid &initialGrid, coord2D _currentRectInit, coord2D _currentRectEnd);
+    void MarkPartialRectangleOccupied(OccupancyGrid &currentGrid, coord2D _currentRectInit, coord2D _currentRectEnd, int value);
+    bool IsGridComplete(const OccupancyGrid &initialGrid);
+    bool IsValidSolution(const OccupancyGrid &initialGrid, const coord2D &_currentRect);
+    bool IsValid(const OccupancyGrid &occupiedGrid, const coord2D &_pos, const coord2D &_rect);
     int CalculateRectangleArea(const coord2D &_rectInit, const coord2D &_rectEnd);
-    int CalculateNumBlanks(const vector<vector<int>> &initialGrid);
-    bool takeOption(int option, const vector<vector<int>> &marksGrid, const coord2D &_lastPos, const coord2D &_lastRect, coord2D &_nextPos, coord2D &_nextRect,
+    int CalculateNumBlanks(const OccupancyGrid &initialGrid);
+    bool takeOption(int option, const OccupancyGrid &marksGrid, const coord2D &_lastPos, const coord2D &_lastRect, coord2D &_nextPos, coord2D &_nextRect,
         int &numBlanksClosed);
 
     ////////////////////////////////////////////////////////////////////////////
     // ALGORITHM
     ////////////////////////////////////////////////////////////////////////////
-    void CalculateRectanglesRecursive(vector<vector<int>> &marksGrid, vector<rectangle> &bestSolution, int &bestCost,
+    void CalculateRectanglesRecursive(OccupancyGrid &marksGrid, vector<rectangle> &bestSolution, int &bestCost,
         coord2D _currentPos, coord2D _currentRect, vector<rectangle> &_currentSolution, int &_currentCost,
         int level, int &numBlanks);
-    void CalculateRectanglesIterative(vector<vector<int>> &marksGrid, vector<rectangle> &bestSolution, int &bestCost,
-        coord2D _currentPos, coord2D _currentRect, int &numBlanks);
+    void CalculateRectanglesIterative(OccupancyGrid &marksGrid, vector<rectangle> &bestSolution, int &bestCost,
+        int &numBlanks);
+    // One step of the iterative algorithm: opens a rectangle in the next blank of the
+    // cursor, closes it and marks it occupied. False when the grid is complete.
+    bool NextIterativeRectangle(OccupancyGrid &marksGrid, BlankCursor &firstBlankCursor, rectangle &rect);
+    // Same greedy as the iterative one, on blank runs: the run end is MOVE RIGHT, a run
+    // holding the whole span below is MOVE DOWN, and marking splits the runs
+    void CalculateRectanglesRunLength(RunLengthGrid &marksGrid, vector<rectangle> &solution, int &cost);
+    void CalculateRectanglesLargestEmpty(OccupancyGrid &marksGrid, vector<rectangle> &solution, int &cost);
+    void CalculateRectanglesExact(OccupancyGrid &marksGrid, vector<rectangle> &solution, int &cost);
+    // Optimal partition from the compile-time table (SmallBlockTable.h). False, and
+    // nothing done, if the grid doesn't fit in a small block.
+    bool CalculateRectanglesSmallBlock(const OccupancyGrid &grid, vector<rectangle> &solution, int &cost);
+    // Starts from the greedy solution and searches for a better one for at most maxNodes
+    // nodes. Returns true when the solution is proven optimal. numThreads <= 0: all the cores.
+    bool CalculateRectanglesBranchAndBound(OccupancyGrid &marksGrid, vector<rectangle> &solution, int &cost,
+        long long maxNodes = 2000000, int numThreads = 1);
 
-    int CalculateRectangles(const vector<vector<int>> &initialGrid, vector<rectangle> &solution);
+    int CalculateRectangles(OccupancyGrid copyGrid, vector<rectangle> &solution,
+        TessellationMode mode = TessellationMode::ITERATIVE);
+    // Parallel: horizontal bands of bandHeight rows solved on a thread pool, then merged
+    // across the seams. The result doesn't depend on numThreads (<= 0: all the cores).
+    int CalculateRectanglesTiled(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+        TessellationMode tileMode = TessellationMode::ITERATIVE, int numThreads = 0, int bandHeight = 256,
+        TiledStats *stats = NULL);
+    // Every connected blank area is solved on its own (in parallel). Exact for any mode:
+    // the areas never interact. Results come in row-major order of the areas.
+    // Areas fitting in a small block are always solved optimally, from the table.
+    int CalculateRectanglesByComponents(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+        TessellationMode mode = TessellationMode::ITERATIVE, int numThreads = 0);
+    // Portfolio: the greedy engines (ITERATIVE, LARGEST_EMPTY) run on the grid in its 8
+    // orientations (transposed, mirrored) at the same time. The fewest rectangles win;
+    // ties go to the smallest total perimeter (fewer slivers), then to the first variant.
+    int CalculateRectanglesPortfolio(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+        int numThreads = 0);
+    // Anytime: the greedy solution is ready right away, then the connected areas are
+    // solved exactly (the ones with most greedy rectangles first) until the budget runs
+    // out. The budget is checked between areas: a running one is always finished.
+    int CalculateRectanglesAnytime(const OccupancyGrid &initialGrid, vector<rectangle> &solution,
+        double timeBudgetSeconds, ProgressCallback onImprovement = nullptr);
+    // Incremental: newGrid is the grid after changing changedCells (either way). Only the
+    // rectangles around the changes are freed and solved again; solution is updated and
+    // the delta comes back in removed/added (rectangles in both are left out).
+    // The freed rectangles are found through the index, so the cost follows the size of
+    // the change; keep the index alive between calls (the solution order isn't kept).
+    int RetessellateChanges(const OccupancyGrid &newGrid, const vector<coord2D> &changedCells,
+        vector<rectangle> &solution, SolutionIndex &index, vector<rectangle> &removed, vector<rectangle> &added,
+        TessellationMode mode = TessellationMode::ITERATIVE);
+    // One-off change: builds the index first (a pass over the whole grid)
+    int RetessellateChanges(const OccupancyGrid &newGrid, const vector<coord2D> &changedCells,
+        vector<rectangle> &solution, vector<rectangle> &removed, vector<rectangle> &added,
+        TessellationMode mode = TessellationMode::ITERATIVE);
+    // Local search on any solution: merges neighbours 2 into 1 and re-cuts 3 into 2,
+    // until nothing improves or maxMoves (< 0: no limit) is reached. Returns the new count.
+    int OptimizeRectangles(vector<rectangle> &solution, long long maxMoves = -1);
+    // ITERATIVE works on the runs; the other modes on the grid unpacked from them
+    int CalculateRectangles(RunLengthGrid copyGrid, vector<rectangle> &solution,
+        TessellationMode mode = TessellationMode::ITERATIVE);
+    // Legacy grids (1 = occupied) are converted to an OccupancyGrid
+    int CalculateRectangles(const vector<vector<int>> &initialGrid, vector<rectangle> &solution,
+        TessellationMode mode = TessellationMode::ITERATIVE);
 
 private:
+    // Component (bounding box) coordinates back to grid coordinates
+    void OffsetRectangles(vector<rectangle> &rects, const coord2D &origin);
+    void MergeAcrossSeams(vector<rectangle> &rects, const OccupancyGrid &initialGrid, int bandHeight, TiledStats &stats);
 
+    ////////////////////////////////////////////////////////////////////////////
+    // EXACT SOLVER AUX FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    bool CellIsBlank(const OccupancyGrid &grid, int x, int y);
+    int NumBlankCellsAroundVertex(const OccupancyGrid &grid, int vx, int vy);
+    coord2D ConcaveVertexExtension(const OccupancyGrid &grid, int vx, int vy);
+    bool EdgeIsInterior(const OccupancyGrid &grid, const coord2D &_vertex, const coord2D &_dir);
+    void FindChords(const OccupancyGrid &grid, vector<chord> &hChords, vector<chord> &vChords);
 };
@@ -0,0 +1,174 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+// Pool and queue of the worker running in this thread (none outside the workers,
+// or the pool a waiting thread is running a task for)
+static thread_local ThreadPool *currentPool = NULL;
+static thread_local int currentWorker = -1;
+
+ThreadPool::ThreadPool(int numThreads) :
+    _pendingTasks(0), _nextQueue(0), _stop(false)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = max(1, (int)thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        _queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 0; i < numThreads; ++i)
+    {
+        _workers.push_back(thread(&ThreadPool::WorkerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    Wait();
+    {
+        lock_guard<mutex> guard(_sleepLock);
+        _stop = true;
+    }
+    _wakeUp.notify_all();
+    for (int i = 0; i < _workers.size(); ++i)
+    {
+        _workers[i].join();
+    }
+}
+
+ThreadPool *ThreadPool::Current()
+{
+    return currentPool;
+}
+
+void ThreadPool::Submit(function<void()> task, TaskGroup *group)
+{
+    int index = (currentPool == this) ? currentWorker : (int)(_nextQueue++ % _queues.size());
+
+    _pendingTasks++;
+    if (group != NULL)
+    {
+        group->_pendingTasks++;
+    }
+
+    Task newTask = { std::move(task), group };
+    {
+        lock_guard<mutex> guard(_queues[index]->lock);
+        _queues[index]->tasks.push_back(std::move(newTask));
+    }
+    {
+        // Taking the lock avoids a lost wake-up with a worker going to sleep
+        lock_guard<mutex> guard(_sleepLock);
+    }
+    _wakeUp.notify_one();
+}
+
+void ThreadPool::Wait(TaskGroup &group)
+{
+    WaitFor(group._pendingTasks);
+}
+
+void ThreadPool::Wait()
+{
+    WaitFor(_pendingTasks);
+}
+
+void ThreadPool::WaitFor(atomic<int> &pendingTasks)
+{
+    int index = (currentPool == this) ? currentWorker : 0;
+    Task task;
+    while (pendingTasks > 0)
+    {
+        if (TryTakeTask(index, task))
+        {
+            // A waiting thread from outside (or from another pool) runs the task as
+            // one of this pool's workers, so the parallel calls nested in it share
+            // this pool too
+            ThreadPool *callerPool = currentPool;
+            int callerWorker = currentWorker;
+            currentPool = this;
+            currentWorker = index;
+            RunTask(task);
+            currentPool = callerPool;
+            currentWorker = callerWorker;
+        }
+        else
+        {
+            // Remaining tasks are running in other workers
+            unique_lock<mutex> guard(_sleepLock);
+            _allDone.wait_for(guard, chrono::milliseconds(1), [&pendingTasks] { return pendingTasks == 0; });
+        }
+    }
+}
+
+void ThreadPool::WorkerLoop(int index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    Task task;
+    while (true)
+    {
+        if (TryTakeTask(index, task))
+        {
+            RunTask(task);
+            continue;
+        }
+
+        unique_lock<mutex> guard(_sleepLock);
+        if (_stop)
+            return;
+        // Timed, so a task pushed while scanning the queues is never missed for long
+        _wakeUp.wait_for(guard, chrono::milliseconds(10));
+        if (_stop)
+            return;
+    }
+}
+
+bool ThreadPool::TryTakeTask(int index, Task &task)
+{
+    // OWN QUEUE (newest first)
+    {
+        WorkerQueue &own = *_queues[index];
+        lock_guard<mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // STEAL (oldest first)
+    for (int i = 1; i < _queues.size(); ++i)
+    {
+        WorkerQueue &victim = *_queues[(index + i) % _queues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::RunTask(Task &task)
+{
+    task.work();
+    task.work = nullptr;
+
+    bool groupDone = (task.group != NULL && --task.group->_pendingTasks == 0);
+    bool poolDone = (--_pendingTasks == 0);
+    if (groupDone || poolDone)
+    {
+        lock_guard<mutex> guard(_sleepLock);
+        _allDone.notify_all();
+    }
+}
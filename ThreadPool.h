@@ -0,0 +1,113 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+// TASK GROUP
+// Counts the unfinished tasks submitted with it, so one batch can be waited for
+// (even from inside another task) while the pool keeps running others.
+////////////////////////////////////////////////////////////////////////////////
+class TaskGroup {
+
+public:
+    TaskGroup() : _pendingTasks(0) {}
+
+private:
+    friend class ThreadPool;
+    atomic<int> _pendingTasks;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// WORK-STEALING THREAD POOL
+// Every worker owns a task queue: it takes its own tasks from the back (last
+// submitted first, good for recursive splitting) and, when it runs out, steals
+// the oldest ones from the front of the other queues.
+// Tasks submitted from a worker go to its own queue; the rest are spread
+// round-robin.
+////////////////////////////////////////////////////////////////////////////////
+class ThreadPool {
+
+public:
+    // numThreads <= 0 uses one thread per hardware core
+    explicit ThreadPool(int numThreads = 0);
+    ~ThreadPool();
+
+    int NumThreads() const { return (int)_workers.size(); }
+
+    // Pool the calling thread is running a task for (NULL outside the tasks)
+    static ThreadPool *Current();
+
+    void Submit(function<void()> task, TaskGroup *group = NULL);
+    // Block until the tasks of the group have finished. The caller runs queued
+    // tasks meanwhile, so it can be used from inside a task.
+    void Wait(TaskGroup &group);
+    // Block until every submitted task has finished (not from inside a task)
+    void Wait();
+
+private:
+    struct Task
+    {
+        function<void()> work;
+        TaskGroup *group;
+    };
+
+    struct WorkerQueue
+    {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<unique_ptr<WorkerQueue>> _queues;
+    vector<thread> _workers;
+    atomic<int> _pendingTasks;
+    atomic<unsigned> _nextQueue;
+    atomic<bool> _stop;
+    mutex _sleepLock;
+    condition_variable _wakeUp;
+    condition_variable _allDone;
+
+    void WorkerLoop(int index);
+    void WaitFor(atomic<int> &pendingTasks);
+    bool TryTakeTask(int index, Task &task);
+    void RunTask(Task &task);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// SHARED POOL
+// The pool for a parallel call: the one the caller is already running in, if
+// any, so nested parallel calls share its workers instead of each starting a
+// pool of its own (and multiplying the threads). Otherwise a new pool of
+// numThreads, released at the end of the scope.
+// The tasks must be waited for with a TaskGroup: the pool can be running others.
+////////////////////////////////////////////////////////////////////////////////
+class SharedPool {
+
+public:
+    explicit SharedPool(int numThreads) :
+        _pool(ThreadPool::Current())
+    {
+        if (_pool == NULL)
+        {
+            _ownPool.reset(new ThreadPool(numThreads));
+            _pool = _ownPool.get();
+        }
+    }
+
+    ThreadPool &operator*() const { return *_pool; }
+    ThreadPool *operator->() const { return _pool; }
+
+private:
+    unique_ptr<ThreadPool> _ownPool;
+    ThreadPool *_pool;
+
+    SharedPool(const SharedPool &);
+    SharedPool &operator=(const SharedPool &);
+};
@@ -3,9 +3,11 @@
 #include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <string>
 using namespace std;
 
 #include "Tessellator.h"
+#include "RectangleGenerator.h"
 #include "AuxStructures.h"
 #include "ACXUtilities.h"
 
@@ -14,12 +16,29 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////////
 int main(int argc, const char * argv[])
 {
-    Tessellator tess;
     ACXUtilities acxUtils;
 
-    if (argc != 5)
+    // Optional parameters after the 4 files:
+    // -incremental: keep the existant connections, only link the NEW areas
+    // -quads / -triangles: minimal navMesh polygons per NEW area instead of a tile per cell
+    bool incremental = false;
+    MeshMode meshMode = MeshMode::TILES;
+    bool validOptions = (argc >= 5);
+    for (int i = 5; i < argc; ++i)
     {
-        std::cout << "ERROR: you must pass 4 parameters (path, ACXfilename, ACXFilenameBACKUP, ACXFilenameNEW)" << endl;
+        std::string option(argv[i]);
+        if (option == "-incremental")
+            incremental = true;
+        else if (option == "-quads")
+            meshMode = MeshMode::QUADS;
+        else if (option == "-triangles")
+            meshMode = MeshMode::TRIANGLES;
+        else
+            validOptions = false;
+    }
+    if (!validOptions)
+    {
+        std::cout << "ERROR: you must pass 4 parameters (path, ACXfilename, ACXFilenameBACKUP, ACXFilenameNEW) [-incremental] [-quads | -triangles]" << endl;
         return -1;
     }
 
@@ -31,22 +50,37 @@ int main(int argc, const char * argv[])
     std::cout << "Loading " << path << ACXFilename << "..." << endl;
     acxUtils.LoadACX(path, ACXFilename, ACXFilenameBACKUP);
 
+    // Compressed: the grid follows the sides of the StreamedAreas, not the world size
     std::cout << "Parsing to Array..." << endl;
-    vector<vector<int>> initialGrid = acxUtils.ParseToArray();
+    OccupancyGrid initialGrid = acxUtils.ParseToCompressedArray();
 
-    vector<rectangle> solution;
-    std::cout << "Calculating solution..." << endl;
-    int numRects = tess.CalculateRectangles(initialGrid, solution);
+    // The generator steps the iterative solver in the background: each rectangle gets
+    // its StreamedArea (and its tiles) while the next ones are still being calculated.
+    // (The exact modes only hand out rectangles once the whole grid is solved.)
+    std::cout << "Calculating solution and adding new StreamedAreas..." << endl;
+    RectangleGenerator generator(std::move(initialGrid), TessellationMode::ITERATIVE, true);
+    int numRects = 0;
+    rectangle rect;
+    while (generator.Next(rect))
+    {
+        ACE_StreamedArea *area = acxUtils.CreateNewStreamedArea(rect);
+        if (meshMode == MeshMode::TILES)
+        {
+            acxUtils.GenerateTessellatedMeshBarrierAndNavMesh(area);
+        }
+        numRects++;
+    }
     std::cout << "RESULT: " << numRects << " NEW rectangles." << endl;
 
-    std::cout << "Adding new StreamedAreas..." << endl;
-    acxUtils.CreateNewStreamedAreas(solution);
-
-    std::cout << "Generating tessellation of MeshBarriers navMeshes..." << endl;
-    acxUtils.GenerateTessellatedMeshBarriersAndNavMeshes();
+    // The T-junctions of the coarse meshes need all the neighbours of each area
+    if (meshMode != MeshMode::TILES)
+    {
+        std::cout << "Generating coarse MeshBarriers navMeshes..." << endl;
+        acxUtils.GenerateTessellatedMeshBarriersAndNavMeshes(meshMode);
+    }
 
     std::cout << "Creating connections..." << endl;
-    acxUtils.CreateConnections();
+    acxUtils.CreateConnections(incremental);
 
     //std::cout << "Creating pathfinding character..." << endl;
     //acxUtils.CreatePathFindingCharacter();
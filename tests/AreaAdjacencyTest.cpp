@@ -0,0 +1,126 @@
+// Standalone test, no AI.Implant needed:
+//     g++ -std=c++14 -O2 -I.. AreaAdjacencyTest.cpp ../AreaAdjacency.cpp -o AreaAdjacencyTest
+// Returns the number of failed checks.
+#include <stdio.h>
+#include <random>
+
+#include "AreaAdjacency.h"
+
+static int numFailed = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { printf("FAILED line %d: %s\n", __LINE__, #condition); numFailed++; }
+
+static const double CELL_SIZE = 10;
+
+// Random rectangles over a grid with holes, numbered in row-major order of their
+// upper-left cell: labels (cell -> area) and bounds (world coordinates, y up)
+static void RandomAreas(mt19937 &random, int width, int height, vector<int> &labels, vector<areaBounds> &areas)
+{
+    labels.assign(width * height, -1);
+    vector<bool> hole(width * height);
+    int holePercent = random() % 40;
+    for (int i = 0; i < width * height; ++i)
+    {
+        hole[i] = (int)(random() % 100) < holePercent;
+    }
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            if (hole[y * width + x] || labels[y * width + x] != -1)
+                continue;
+
+            // RIGHT while free, up to a random width; DOWN while the whole span is free
+            int maxWidth = 1 + random() % 8;
+            int x1 = x;
+            while (x1 + 1 < width && x1 + 1 - x < maxWidth && !hole[y * width + x1 + 1] && labels[y * width + x1 + 1] == -1)
+            {
+                x1++;
+            }
+            int maxHeight = 1 + random() % 8;
+            int y1 = y;
+            bool free = true;
+            while (free && y1 + 1 < height && y1 + 1 - y < maxHeight)
+            {
+                for (int cx = x; cx <= x1 && free; ++cx)
+                {
+                    free = !hole[(y1 + 1) * width + cx] && labels[(y1 + 1) * width + cx] == -1;
+                }
+                if (free)
+                    y1++;
+            }
+
+            int area = areas.size();
+            for (int cy = y; cy <= y1; ++cy)
+            {
+                for (int cx = x; cx <= x1; ++cx)
+                {
+                    labels[cy * width + cx] = area;
+                }
+            }
+            areas.push_back(areaBounds(x * CELL_SIZE, -(y1 + 1) * CELL_SIZE, (x1 + 1) * CELL_SIZE, -y * CELL_SIZE));
+        }
+    }
+}
+
+int main()
+{
+    mt19937 random(3);
+    for (int test = 0; test < 500; ++test)
+    {
+        int width = 1 + random() % 50;
+        int height = 1 + random() % 50;
+        vector<int> labels;
+        vector<areaBounds> areas;
+        RandomAreas(random, width, height, labels, areas);
+
+        vector<areaLink> labelLinks;
+        vector<areaLink> sweepLinks;
+        int numUnlabelled = LabelMapLinks(labels, width, height, labelLinks);
+        SweepLinks(areas, sweepLinks);
+
+        // SAME LINKS, in the same order
+        CHECK(labelLinks.size() == sweepLinks.size());
+        for (int i = 0; i < labelLinks.size() && i < sweepLinks.size(); ++i)
+        {
+            CHECK(labelLinks[i].area1 == sweepLinks[i].area1 && labelLinks[i].area2 == sweepLinks[i].area2);
+
+            // A shared side: a vertical or horizontal segment of some length
+            const areaBounds &segment = sweepLinks[i].segment;
+            CHECK((segment.minX == segment.maxX) != (segment.minY == segment.maxY));
+        }
+
+        // Cells without area right after (or under) a cell with one
+        int expectedUnlabelled = 0;
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                if (labels[y * width + x] != -1)
+                    continue;
+                if (x > 0 && labels[y * width + x - 1] != -1)
+                    expectedUnlabelled++;
+                if (y > 0 && labels[(y - 1) * width + x] != -1)
+                    expectedUnlabelled++;
+            }
+        }
+        CHECK(numUnlabelled == expectedUnlabelled);
+
+        // Only the new areas: the links with one of them
+        int firstNewArea = areas.size() / 2;
+        vector<areaLink> newLinks;
+        SweepLinks(areas, newLinks, firstNewArea);
+        int expectedNewLinks = 0;
+        for (int i = 0; i < labelLinks.size(); ++i)
+        {
+            if (labelLinks[i].area1 >= firstNewArea || labelLinks[i].area2 >= firstNewArea)
+                expectedNewLinks++;
+        }
+        CHECK((int)newLinks.size() == expectedNewLinks);
+    }
+
+    printf(numFailed == 0 ? "OK\n" : "%d FAILED\n", numFailed);
+    return numFailed;
+}
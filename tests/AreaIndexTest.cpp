@@ -0,0 +1,109 @@
+// Standalone test, no AI.Implant needed:
+//     g++ -std=c++14 -O2 -I.. AreaIndexTest.cpp ../AreaIndex.cpp -o AreaIndexTest
+// Returns the number of failed checks.
+#include <stdio.h>
+#include <random>
+#include <chrono>
+
+#include "AreaIndex.h"
+
+static int numFailed = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { printf("FAILED line %d: %s\n", __LINE__, #condition); numFailed++; }
+
+// Both indices must give the same area for every point, through the interface
+static void CheckSameAnswers(AreaIndex &reference, AreaIndex &index, const areaBounds &world,
+    int numAreas, double cellSize, mt19937 &random)
+{
+    int numCellsX = (int)((world.maxX - world.minX) / cellSize);
+    int numCellsY = (int)((world.maxY - world.minY) / cellSize);
+
+    // Areas on the cell lattice (overlapping, and some out of the world)
+    for (int i = 0; i < numAreas; ++i)
+    {
+        int x = (int)(random() % (numCellsX + 4)) - 2;
+        int y = (int)(random() % (numCellsY + 4)) - 2;
+        int width = random() % 10;
+        int height = random() % 10;
+        areaBounds bounds(world.minX + x * cellSize, world.minY + y * cellSize,
+            world.minX + (x + width) * cellSize, world.minY + (y + height) * cellSize);
+        CHECK(reference.Add(bounds) == i);
+        CHECK(index.Add(bounds) == i);
+    }
+    CHECK(reference.Size() == index.Size());
+
+    // Points inside the cells, on their sides and corners, and out of the world
+    for (int q = 0; q < 5000; ++q)
+    {
+        double x = world.minX + ((int)(random() % (numCellsX * 4 + 16)) - 8) * cellSize / 4;
+        double y = world.minY + ((int)(random() % (numCellsY * 4 + 16)) - 8) * cellSize / 4;
+        CHECK(reference.FindFirst(x, y) == index.FindFirst(x, y));
+    }
+}
+
+int main()
+{
+    mt19937 random(5);
+
+    // RANDOM WORLDS: off-origin, several cell sizes
+    for (int test = 0; test < 100; ++test)
+    {
+        double cellSize = 1 + random() % 5;
+        int numCellsX = 1 + random() % 60;
+        int numCellsY = 1 + random() % 60;
+        double originX = -numCellsX * cellSize / 2;
+        double originY = -numCellsY * cellSize / 3;
+        areaBounds world(originX, originY, originX + numCellsX * cellSize, originY + numCellsY * cellSize);
+
+        LinearAreaIndex linear;
+        BucketGridAreaIndex buckets(world, 4 * cellSize);
+        CheckSameAnswers(linear, buckets, world, random() % 300, cellSize, random);
+
+        // Refilled after a Clear, numbered from 0 again
+        linear.Clear();
+        buckets.Clear();
+        CHECK(buckets.Size() == 0);
+        CHECK(buckets.FindFirst(originX, originY) == -1);
+        CheckSameAnswers(linear, buckets, world, random() % 100, cellSize, random);
+    }
+
+    // BENCHMARK: a world of 500x500 unit areas, one query per cell
+    const int N = 500;
+    LinearAreaIndex linear;
+    BucketGridAreaIndex buckets(areaBounds(0, 0, N, N), 4);
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            linear.Add(areaBounds(x, y, x + 1, y + 1));
+            buckets.Add(areaBounds(x, y, x + 1, y + 1));
+        }
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            CHECK(buckets.FindFirst(x + 0.5, y + 0.5) == y * N + x);
+        }
+    }
+    double bucketSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // The linear index on a few rows only (the middle ones: it tests the areas in order)
+    const int LINEAR_ROWS = 4;
+    start = chrono::steady_clock::now();
+    for (int y = N / 2; y < N / 2 + LINEAR_ROWS; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            CHECK(linear.FindFirst(x + 0.5, y + 0.5) == y * N + x);
+        }
+    }
+    double linearSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() * N / LINEAR_ROWS;
+    printf("%d queries: bucket grid %.3fs, linear %.1fs (estimated)\n", N * N, bucketSeconds, linearSeconds);
+
+    printf(numFailed == 0 ? "OK\n" : "%d FAILED\n", numFailed);
+    return numFailed;
+}
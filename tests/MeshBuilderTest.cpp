@@ -0,0 +1,79 @@
+// Standalone test, no AI.Implant needed:
+//     g++ -std=c++14 -I.. MeshBuilderTest.cpp ../MeshBuilder.cpp -o MeshBuilderTest
+// Returns the number of failed checks.
+#include <stdio.h>
+#include <math.h>
+
+#include "MeshBuilder.h"
+
+static int numFailed = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { printf("FAILED line %d: %s\n", __LINE__, #condition); numFailed++; }
+
+// Tiles of an area must cover exactly its bounds, with every inner line on the lattice
+static void CheckTiles(double minX, double minY, double maxX, double maxY, double originX, double originY, double tileSize)
+{
+    vector<double> xs = MeshBuilder::LatticeLines(minX, maxX, originX, tileSize);
+    vector<double> ys = MeshBuilder::LatticeLines(maxY, minY, originY, tileSize);
+    MeshBuilder builder;
+    builder.AddTileLattice(xs, ys);
+
+    CHECK(xs.front() == minX && xs.back() == maxX);
+    CHECK(ys.front() == maxY && ys.back() == minY);
+    for (int i = 1; i + 1 < xs.size(); ++i)
+    {
+        double k = (xs[i] - originX) / tileSize;
+        CHECK(fabs(k - floor(k + 0.5)) < 1e-9);
+    }
+    for (int j = 1; j + 1 < ys.size(); ++j)
+    {
+        double k = (ys[j] - originY) / tileSize;
+        CHECK(fabs(k - floor(k + 0.5)) < 1e-9);
+    }
+
+    double totalArea = 0;
+    for (int p = 0; p < builder.NumPolygons(); ++p)
+    {
+        CHECK(builder.PolygonSize(p) == 4);
+        const int *indices = builder.PolygonIndices(p);
+        const meshVertex &upperLeft = builder.Vertex(indices[0]);
+        const meshVertex &lowerRight = builder.Vertex(indices[2]);
+        double width = lowerRight.x - upperLeft.x;
+        double height = upperLeft.y - lowerRight.y;
+        CHECK(width > 0 && width <= tileSize + 1e-9);
+        CHECK(height > 0 && height <= tileSize + 1e-9);
+        CHECK(upperLeft.x >= minX && lowerRight.x <= maxX && lowerRight.y >= minY && upperLeft.y <= maxY);
+        totalArea += width * height;
+    }
+    CHECK(fabs(totalArea - (maxX - minX) * (maxY - minY)) < 1e-6);
+}
+
+int main()
+{
+    // ON THE LATTICE: whole tiles only
+    CheckTiles(0, 0, 300, 200, 0, 0, 100);
+    {
+        MeshBuilder builder;
+        builder.AddTileLattice(MeshBuilder::LatticeLines(0, 300, 0, 100), MeshBuilder::LatticeLines(200, 0, 0, 100));
+        CHECK(builder.NumPolygons() == 6);
+        CHECK(builder.NumVertices() == 12);
+    }
+
+    // OFF-LATTICE SIDES: partial tiles at the ends, never a rounded tile count
+    CheckTiles(30, -70, 275, 160, 0, 0, 100);
+    CheckTiles(-1234.5, -50.25, -1000.75, 12.5, 0, 0, 100);
+    CheckTiles(10, 10, 60, 60, 0, 0, 100); // inside a single cell
+    {
+        MeshBuilder builder;
+        builder.AddTileLattice(MeshBuilder::LatticeLines(50, 260, 0, 100), MeshBuilder::LatticeLines(150, 0, 0, 100));
+        CHECK(builder.NumPolygons() == 3 * 2); // x: 50-100-200-260, y: 150-100-0
+    }
+
+    // A side a rounding error away from the lattice doesn't give a sliver tile
+    CheckTiles(0, 0, 300.0000000001, 200, 0, 0, 100);
+    CHECK(MeshBuilder::LatticeLines(0, 300.0000000001, 0, 100).size() == 4);
+
+    printf(numFailed == 0 ? "OK\n" : "%d FAILED\n", numFailed);
+    return numFailed;
+}
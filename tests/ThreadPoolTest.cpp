@@ -0,0 +1,141 @@
+// Standalone test, no AI.Implant needed:
+//     g++ -std=c++14 -O2 -pthread -I.. ThreadPoolTest.cpp $(ls ../*.cpp | grep -v -e main.cpp -e ACXUtilities.cpp) -o ThreadPoolTest
+// Returns the number of failed checks. The thread count is read from /proc (Linux only).
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <fstream>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "Tessellator.h"
+#include "ThreadPool.h"
+
+static int numFailed = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { printf("FAILED line %d: %s\n", __LINE__, #condition); numFailed++; }
+
+static int NumProcessThreads()
+{
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+    {
+        if (line.compare(0, 8, "Threads:") == 0)
+            return atoi(line.c_str() + 8);
+    }
+    return -1;
+}
+
+// Peak number of threads of the process while running a call (the monitor not included)
+static int PeakThreads(function<void()> call)
+{
+    atomic<int> peak(0);
+    atomic<bool> running(true);
+    thread monitor([&peak, &running]
+    {
+        while (running)
+        {
+            int numThreads = NumProcessThreads();
+            if (numThreads > peak)
+                peak = numThreads;
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+    });
+    call();
+    running = false;
+    monitor.join();
+    return peak - 1;
+}
+
+// Every cell covered once, and only the blank ones
+static bool IsPartition(const OccupancyGrid &grid, const vector<rectangle> &solution)
+{
+    vector<int> covered(grid.Width() * grid.Height(), 0);
+    for (int r = 0; r < solution.size(); ++r)
+    {
+        for (int y = solution[r].corner1.y; y <= solution[r].corner2.y; ++y)
+        {
+            for (int x = solution[r].corner1.x; x <= solution[r].corner2.x; ++x)
+            {
+                if (grid.IsOccupied(x, y) || covered[y * grid.Width() + x]++ != 0)
+                    return false;
+            }
+        }
+    }
+    for (int y = 0; y < grid.Height(); ++y)
+    {
+        for (int x = 0; x < grid.Width(); ++x)
+        {
+            if (!grid.IsOccupied(x, y) && covered[y * grid.Width() + x] == 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+static OccupancyGrid RandomGrid(int width, int height)
+{
+    static mt19937 random(1);
+    OccupancyGrid grid(width, height);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            grid.Set(x, y, random() % 100 < 40);
+        }
+    }
+    return grid;
+}
+
+int main()
+{
+    if (NumProcessThreads() < 0)
+    {
+        printf("SKIPPED: no /proc/self/status\n");
+        return 0;
+    }
+
+    OccupancyGrid grid = RandomGrid(64, 64);
+    OccupancyGrid smallGrid = RandomGrid(32, 16); // the exact search takes long on more
+
+    // NESTED PARALLEL CALLS: the inner ones run on the outer pool, whether their
+    // task is taken by a worker or by the waiting main thread
+    const int NUM_THREADS = 2;
+    Tessellator tess;
+    vector<rectangle> solution;
+    int peak;
+
+    peak = PeakThreads([&] { tess.CalculateRectanglesTiled(grid, solution, TessellationMode::PORTFOLIO, NUM_THREADS, 8); });
+    CHECK(IsPartition(grid, solution));
+    CHECK(peak <= NUM_THREADS + 1);
+
+    solution.clear();
+    peak = PeakThreads([&] { tess.CalculateRectanglesByComponents(grid, solution, TessellationMode::PORTFOLIO, NUM_THREADS); });
+    CHECK(IsPartition(grid, solution));
+    CHECK(peak <= NUM_THREADS + 1);
+
+    solution.clear();
+    peak = PeakThreads([&] { tess.CalculateRectanglesTiled(smallGrid, solution, TessellationMode::PARALLEL_BRANCH_AND_BOUND, NUM_THREADS, 4); });
+    CHECK(IsPartition(smallGrid, solution));
+    CHECK(peak <= NUM_THREADS + 1);
+
+    solution.clear();
+    peak = PeakThreads([&] { tess.CalculateRectanglesByComponents(smallGrid, solution, TessellationMode::PARALLEL_BRANCH_AND_BOUND, NUM_THREADS); });
+    CHECK(IsPartition(smallGrid, solution));
+    CHECK(peak <= NUM_THREADS + 1);
+
+    // OUTSIDE A TASK the call gets a pool of its own, gone when it returns
+    CHECK(ThreadPool::Current() == NULL);
+    solution.clear();
+    peak = PeakThreads([&] { tess.CalculateRectanglesPortfolio(smallGrid, solution, NUM_THREADS); });
+    CHECK(IsPartition(smallGrid, solution));
+    CHECK(peak <= NUM_THREADS + 1);
+    CHECK(NumProcessThreads() == 1);
+
+    printf(numFailed == 0 ? "OK\n" : "%d FAILED\n", numFailed);
+    return numFailed;
+}